@@ -10,7 +10,7 @@ LOCAL_CFLAGS += -g -std=c99
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/$(SDL_PATH)/include
 
-YOUR_SRC_FILES= dlist.c game_sdl.c game_tools.c game.c graphic_mode.c  queue.c game_aux.c
+YOUR_SRC_FILES= game_sdl.c game_tools.c game.c graphic_mode.c glyph_atlas.c level_pack.c queue.c game_aux.c game_scan.c arena.c solution_cache.c game_state.c
 
 LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c $(YOUR_SRC_FILES)
 
@@ -0,0 +1 @@
+../../../arena.c
\ No newline at end of file
@@ -1 +0,0 @@
-../../../dlist.c
\ No newline at end of file
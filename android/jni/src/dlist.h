@@ -1 +0,0 @@
-../../../dlist.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../game_scan.c
\ No newline at end of file
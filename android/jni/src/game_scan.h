@@ -0,0 +1 @@
+../../../game_scan.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../game_solver_variant.h
\ No newline at end of file
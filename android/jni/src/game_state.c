@@ -0,0 +1 @@
+../../../game_state.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../game_state.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../glyph_atlas.c
\ No newline at end of file
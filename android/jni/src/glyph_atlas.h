@@ -0,0 +1 @@
+../../../glyph_atlas.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../level_pack.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../../level_pack.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../solution_cache.c
\ No newline at end of file
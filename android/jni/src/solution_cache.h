@@ -0,0 +1 @@
+../../../solution_cache.h
\ No newline at end of file
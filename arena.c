@@ -0,0 +1,151 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+  ARENA_ALIGNMENT = 16,         /**< alignment of the blocks */
+  ARENA_DEFAULT_CHUNK = 1 << 16 /**< default size of the chunks */
+};
+
+/**
+ * @brief A piece of memory taken from the heap, in which the blocks are
+ * allocated one after the other.
+ **/
+typedef struct chunk_s {
+  struct chunk_s *prev; /**< chunk allocated before this one */
+  size_t size;          /**< number of bytes in data */
+  size_t used;          /**< number of bytes of data already given */
+  unsigned char data[];
+} chunk;
+
+/**
+ * @brief A function to call when the arena is deleted.
+ **/
+typedef struct cleanup_s {
+  void (*cleanup)(void *);
+  void *data;
+  struct cleanup_s *next;
+} cleanup;
+
+struct arena_s {
+  chunk *current;     /**< chunk the blocks are taken from */
+  size_t chunk_size;  /**< default size of a new chunk */
+  cleanup *cleanups;  /**< functions to call on deletion, last one first */
+};
+
+// Declaration of the functions that aren't given in the .h files
+static chunk *chunk_new(size_t size, chunk *prev);
+static size_t padding(const chunk *c);
+
+/**
+ * @brief Allocates a new chunk
+ * @param size the number of bytes it can hold
+ * @param prev the chunk allocated before it
+ * @return the chunk
+ **/
+chunk *chunk_new(size_t size, chunk *prev) {
+  chunk *c = (chunk *)malloc(sizeof(chunk) + size);
+  if (c == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  c->prev = prev;
+  c->size = size;
+  c->used = 0;
+  return c;
+}
+
+/**
+ * @brief Gives the number of bytes to skip so that the next block of a chunk
+ * is aligned
+ * @param c the chunk
+ * @return the padding
+ **/
+size_t padding(const chunk *c) {
+  uintptr_t next = (uintptr_t)(c->data + c->used);
+  return (ARENA_ALIGNMENT - next % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+}
+
+arena *arena_new(size_t chunk_size) {
+  arena *a = (arena *)malloc(sizeof(arena));
+  if (a == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  a->current = NULL;
+  a->chunk_size = chunk_size == 0 ? ARENA_DEFAULT_CHUNK : chunk_size;
+  a->cleanups = NULL;
+  return a;
+}
+
+void *arena_alloc(arena *a, size_t size) {
+  if (a == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
+    exit(EXIT_FAILURE);
+  }
+  chunk *c = a->current;
+  if (c == NULL || c->used + padding(c) + size > c->size) {
+    // the block doesn't fit: it goes in a new chunk (of its own if it is big)
+    size_t chunk_size = size + ARENA_ALIGNMENT;
+    if (chunk_size < a->chunk_size) {
+      chunk_size = a->chunk_size;
+    }
+    c = chunk_new(chunk_size, c);
+    a->current = c;
+  }
+  c->used += padding(c);
+  void *block = c->data + c->used;
+  c->used += size;
+  return block;
+}
+
+void arena_on_delete(arena *a, void (*cleanup_fn)(void *), void *data) {
+  cleanup *cl = (cleanup *)arena_alloc(a, sizeof(cleanup));
+  cl->cleanup = cleanup_fn;
+  cl->data = data;
+  cl->next = a->cleanups;
+  a->cleanups = cl;
+}
+
+arena_mark arena_get_mark(const arena *a) {
+  if (a == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
+    exit(EXIT_FAILURE);
+  }
+  arena_mark mark;
+  mark.chunk = a->current;
+  mark.used = a->current == NULL ? 0 : a->current->used;
+  return mark;
+}
+
+void arena_release(arena *a, arena_mark mark) {
+  if (a == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
+    exit(EXIT_FAILURE);
+  }
+  // the chunks allocated after the mark are given back to the heap
+  while (a->current != mark.chunk) {
+    chunk *prev = a->current->prev;
+    free(a->current);
+    a->current = prev;
+  }
+  if (a->current != NULL) {
+    a->current->used = mark.used;
+  }
+}
+
+void arena_delete(arena *a) {
+  if (a == NULL) {
+    return;
+  }
+  for (cleanup *cl = a->cleanups; cl != NULL; cl = cl->next) {
+    cl->cleanup(cl->data);
+  }
+  while (a->current != NULL) {
+    chunk *prev = a->current->prev;
+    free(a->current);
+    a->current = prev;
+  }
+  free(a);
+}
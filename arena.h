@@ -0,0 +1,83 @@
+/**
+ * @file arena.h
+ * @brief Arena (bump) allocator.
+ * @details Memory is taken from large chunks, one block after the other, and
+ * is never freed block by block: everything allocated in an arena is released
+ * at once, either back to a mark or when the arena is deleted. This avoids
+ * fragmenting the heap with the scratch memory of the solver, and with the
+ * squares of the games allocated in an arena (see game_new_empty_ext_in).
+ *
+ **/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+#include <stddef.h>
+
+/**
+ * @brief The arena, see @ref arena_new.
+ **/
+typedef struct arena_s arena;
+
+/**
+ * @brief A position in an arena, see @ref arena_get_mark.
+ **/
+typedef struct {
+  void *chunk; /**< chunk in use when the mark was taken */
+  size_t used; /**< number of bytes used in that chunk */
+} arena_mark;
+
+/**
+ * @brief Creates an empty arena
+ * @param chunk_size the size of the chunks taken from the heap, or 0 for the
+ * default size (bigger blocks get a chunk of their own)
+ * @return the arena
+ **/
+arena *arena_new(size_t chunk_size);
+
+/**
+ * @brief Allocates a block of memory in an arena
+ * @details The block is suitably aligned for any type used in this project.
+ * It must not be freed: it is released with the arena.
+ * @param a the arena
+ * @param size the size of the block in bytes
+ * @return the block
+ * @pre @p a must be a valid pointer toward an arena.
+ **/
+void *arena_alloc(arena *a, size_t size);
+
+/**
+ * @brief Registers a function to call when the arena is deleted
+ * @details This is used to release what lives in the arena but owns memory
+ * outside of it. The functions are called in the reverse order of their
+ * registration.
+ * @param a the arena
+ * @param cleanup the function
+ * @param data the argument given to @p cleanup
+ * @pre @p a must be a valid pointer toward an arena.
+ **/
+void arena_on_delete(arena *a, void (*cleanup)(void *), void *data);
+
+/**
+ * @brief Gives the current position in an arena
+ * @param a the arena
+ * @return the mark, to be given to arena_release
+ * @pre @p a must be a valid pointer toward an arena.
+ **/
+arena_mark arena_get_mark(const arena *a);
+
+/**
+ * @brief Releases all of the blocks allocated since a mark was taken
+ * @param a the arena
+ * @param mark a mark taken on @p a
+ * @pre @p mark must have been taken on @p a, and not released yet.
+ * @pre no cleanup function may have been registered since @p mark was taken.
+ **/
+void arena_release(arena *a, arena_mark mark);
+
+/**
+ * @brief Deletes an arena, and everything that was allocated in it
+ * @param a the arena
+ **/
+void arena_delete(arena *a);
+
+#endif  // __ARENA_H__
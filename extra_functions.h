@@ -1,7 +1,9 @@
 #include "game.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "arena.h"
 #include "game_aux.h"
 #include "game_ext.h"
 #include "queue.h"
@@ -32,6 +34,263 @@ uint *make_array_of_all_adjacent_cells(cgame g, uint i, uint j);
  **/
 uint *make_array_of_ortho_adjacent_cells(cgame g, uint i, uint j);
 
+/**
+ * @brief Plays the squares of a solution, as a single move
+ * @details Every TENT, GRASS or EMPTY square of @p solution that differs from
+ * the one of @p g is played. All of these moves are then undone (and redone)
+ * by a single call to game_undo (and game_redo).
+ * @param g the game
+ * @param solution a game of the same size, usually a solved copy of @p g
+ * @pre @p g and @p solution must be valid pointers toward game structures.
+ **/
+void game_play_solution(game g, cgame solution);
+
+/**
+ * @brief Tells if the square in a given cell is a losing one
+ * @details A square is losing if it is a TENT or a GRASS, and game_check_move
+ * says that playing it again would be LOSING. The numbers of tents of the rows
+ * and columns are kept up to date when the game changes, and so are the
+ * losing flags of the squares of a game that tracks them (see
+ * game_track_losing_squares), so reading all of the squares on each frame is
+ * cheap, and the game isn't changed.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @return true if the square is losing
+ * @pre @p g must be a valid pointer toward a game structure.
+ * @pre @p i < game height
+ * @pre @p j < game width
+ **/
+bool game_is_losing_square(cgame g, uint i, uint j);
+
+/**
+ * @brief Keeps the losing flags of the squares of a game up to date
+ * @details Once it is called, each change of a square updates the flags of
+ * the squares around it, that game_is_losing_square then reads. It is meant
+ * for the game that is drawn: the other games, such as the copies made by the
+ * solver, don't pay for it, and a copy doesn't track its losing squares.
+ * @param g the game
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+void game_track_losing_squares(game g);
+
+/**
+ * @brief Writes a game in the text format of game_save
+ * @details Used by game_save, and to send games through a stream.
+ * @param g the game
+ * @param f the stream, left open
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+void game_write(cgame g, FILE *f);
+
+/**
+ * @brief Gives the number of calls to game_check_move since the program started
+ * @details Only meant for statistics (see game_sdl_bench.c). The count is
+ * atomic, since game_check_move may be called by several threads at once.
+ * @return the number of calls
+ **/
+unsigned long game_nb_check_moves(void);
+
+/**
+ * @brief Rules a hint can come from, from the cheapest to the most expensive
+ * one to check (see game_hint).
+ **/
+typedef enum {
+  HINT_NONE = 0,  /**< no deduction can be made */
+  HINT_BASIC = 1, /**< one of the rules of game_check_move */
+  HINT_TREE = 2,  /**< a tree has a single empty cell left for its tent */
+  HINT_LINE = 3,  /**< the tents left to place in a row or column only fit one
+                     way around the cell */
+} hint_rule;
+
+/**
+ * @brief Gives the next deduction that can be made on a game
+ * @details The rules are tried from the cheapest to the most expensive one,
+ * and the first empty cell that one of them decides is given. The game isn't
+ * changed, so the hint can be asked for at any time, even on every frame.
+ * @param g the game
+ * @param p_i receives the row index of the cell
+ * @param p_j receives the column index of the cell
+ * @param p_s receives the square (TENT or GRASS) that must be in the cell
+ * @return the rule that gave the deduction, or HINT_NONE if there is none
+ * (then @p p_i, @p p_j and @p p_s are left unchanged)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+hint_rule game_hint(cgame g, uint *p_i, uint *p_j, square *p_s);
+
+/**
+ * @brief Limits of a solve (see game_solve_ext and game_nb_solutions_ext).
+ **/
+typedef struct {
+  double time_limit;       /**< seconds the solve may take, 0 for no limit */
+  unsigned long max_nodes; /**< number of tents the search may try, 0 for no
+                              limit */
+  int cancelled;           /**< set by solve_cancel, 0 at first */
+} solve_options;
+
+/**
+ * @brief How a solve ended
+ **/
+typedef enum {
+  SOLVE_FOUND = 0,     /**< a solution was found, or all of them were counted */
+  SOLVE_NONE = 1,      /**< the game has no solution */
+  SOLVE_TIMEOUT = 2,   /**< the time limit or the node budget was reached */
+  SOLVE_CANCELLED = 3, /**< solve_cancel was called */
+} solve_status;
+
+/**
+ * @brief Computes the solution of a game, within some limits
+ * @details Same as game_solve, but the search stops once a limit of @p opts is
+ * reached. Unless a solution is found, @p g is left unchanged.
+ * @param g the game to solve
+ * @param opts the limits, or NULL for none
+ * @return SOLVE_FOUND if @p g has been solved, SOLVE_NONE if it has no
+ * solution, SOLVE_TIMEOUT or SOLVE_CANCELLED if the search was stopped first
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+solve_status game_solve_ext(game g, const solve_options *opts);
+
+/**
+ * @brief Computes the number of solutions of a game, within some limits
+ * @details Same as game_nb_solutions, but the search stops once a limit of
+ * @p opts is reached. @p g is then left unchanged.
+ * @param g the game
+ * @param opts the limits, or NULL for none
+ * @param p_nb_solutions receives the number of solutions, or the number found
+ * before the search was stopped
+ * @return SOLVE_FOUND if there are solutions, SOLVE_NONE if there are none,
+ * SOLVE_TIMEOUT or SOLVE_CANCELLED if the search was stopped first
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+solve_status game_nb_solutions_ext(game g, const solve_options *opts,
+                                   uint *p_nb_solutions);
+
+/**
+ * @brief Solves as much of a game as possible, within some limits
+ * @details When game_solve_ext can't finish, because the game has no solution
+ * or is too big, this still gives a useful partial solution. A best-first
+ * search keeps a bounded number of partial grids, the ones that break the
+ * fewest rules and then have the fewest empty cells, and the best one found
+ * is played in @p g as a single move (see game_play_solution). A cell where
+ * neither a tent nor grass fits is left empty. Since the search may go on for
+ * long on a game without solution, it is meant to be given limits.
+ * @param g the game
+ * @param opts the limits, or NULL for none
+ * @return SOLVE_FOUND if @p g has been solved, SOLVE_NONE if the search ended
+ * without a solution, SOLVE_TIMEOUT or SOLVE_CANCELLED if it was stopped first
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+solve_status game_solve_partial(game g, const solve_options *opts);
+
+/**
+ * @brief Stops the solves that use some options
+ * @details It can be called from any thread: the search notices it the next
+ * time it tries a tent, and its solve returns SOLVE_CANCELLED.
+ * @param opts the options given to the solves
+ **/
+void solve_cancel(solve_options *opts);
+
+/**
+ * @brief A symmetry of a grid: a reflection or a rotation, followed on
+ * wrapping grids by a translation. Each of them keeps the numbers of
+ * solutions of a game.
+ **/
+typedef struct {
+  bool transpose; /**< the rows become the columns */
+  bool flip_rows; /**< then the rows are taken from the bottom up */
+  bool flip_cols; /**< then the columns are taken from right to left */
+  uint shift_i;   /**< then the rows move down by shift_i (wrapping only) */
+  uint shift_j;   /**< and the columns right by shift_j (wrapping only) */
+} game_symmetry;
+
+/**
+ * @brief Gives the cell where a symmetry moves a given cell
+ * @param g the game
+ * @param sym the symmetry
+ * @param i row index of the cell in @p g
+ * @param j column index of the cell in @p g
+ * @param p_i receives the row index of the cell in the transformed game
+ * @param p_j receives the column index of the cell in the transformed game
+ * @pre @p g must be a valid pointer toward a game structure.
+ * @pre @p i < game height
+ * @pre @p j < game width
+ **/
+void game_symmetry_cell(cgame g, game_symmetry sym, uint i, uint j, uint *p_i,
+                        uint *p_j);
+
+/**
+ * @brief Creates the game obtained by applying a symmetry to a game
+ * @details The squares and the expected numbers of tents are moved, the
+ * history isn't kept.
+ * @param g the game
+ * @param sym the symmetry
+ * @return the transformed game
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+game game_transform(cgame g, game_symmetry sym);
+
+/**
+ * @brief Gives the symmetry that moves a game to its canonical orientation
+ * @details All of the games that are symmetric to each other (by one of the 8
+ * reflections or rotations, and by the translations on wrapping grids) have
+ * the same canonical orientation: the one whose size, numbers of tents and
+ * trees come first in lexicographic order. Only the puzzle is looked at, not
+ * the tents and grass that have been played.
+ * @param g the game
+ * @return the symmetry, to be given to game_transform or game_symmetry_cell
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+game_symmetry game_canonical_symmetry(cgame g);
+
+/**
+ * @brief Hashes the canonical orientation of the puzzle of a game
+ * @details Games that are symmetric to each other have the same hash, so it
+ * can be used to find the puzzles that have already been seen. It is the
+ * puzzle_hash of the canonical puzzle, the key of the solution cache.
+ * @param g the game
+ * @return the hash
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint64_t game_canonical_hash(cgame g);
+
+/**
+ * @brief Hashes a puzzle: its size, options, numbers of tents and trees
+ * @param nb_rows the number of rows
+ * @param nb_cols the number of columns
+ * @param wrapping true if the grid wraps
+ * @param diagadj true if the tents may be diagonally adjacent
+ * @param clues the nb_rows numbers of tents of the rows, then the nb_cols
+ * numbers of tents of the columns
+ * @param squares the nb_rows * nb_cols squares, in row-major order, of which
+ * only the trees are looked at
+ * @return the hash (FNV-1a)
+ * @pre @p clues and @p squares must be valid pointers.
+ **/
+uint64_t puzzle_hash(uint nb_rows, uint nb_cols, bool wrapping, bool diagadj,
+                     const uint32_t *clues, const unsigned char *squares);
+
+/**
+ * @brief Gives the squares of a row, stored one byte per square
+ * @param g the game
+ * @param i row index
+ * @return the game_nb_cols(g) squares of the row, from left to right
+ * (valid until the squares of the game change)
+ * @pre @p g must be a valid pointer toward a game structure.
+ * @pre @p i < game height
+ **/
+const unsigned char *game_row_squares(cgame g, uint i);
+
+/**
+ * @brief Gives the squares of a column, stored one byte per square
+ * @param g the game
+ * @param j column index
+ * @return the game_nb_rows(g) squares of the column, from top to bottom
+ * (valid until the squares of the game change)
+ * @pre @p g must be a valid pointer toward a game structure.
+ * @pre @p j < game width
+ **/
+const unsigned char *game_col_squares(cgame g, uint j);
+
 /**
  * @brief Checks if the given game is NULL and exits the program if it is
  * @param g the game
@@ -52,4 +311,34 @@ void test_i_value(cgame g, uint i);
  * @param g the game
  * @param j column index
  **/
-void test_j_value(cgame g, uint j);
\ No newline at end of file
+void test_j_value(cgame g, uint j);
+
+/**
+ * @brief Creates an empty game with the given size and options, allocated in an
+ * arena
+ * @details Same as game_new_empty_ext, but the game is released with the arena
+ * (game_delete does nothing on it). The game structure, its squares and its
+ * numbers of tents are allocated in the arena, which saves these allocations
+ * when thousands of games are processed. The undo and redo histories (and the
+ * moves played) are still allocated on the heap, and are freed when the arena
+ * is deleted.
+ * @param a the arena, or NULL to allocate the game on the heap
+ * @param nb_rows number of rows in game
+ * @param nb_cols number of columns in game
+ * @param wrapping wrapping option
+ * @param diagadj diagadj option
+ * @return the created game
+ **/
+game game_new_empty_ext_in(arena *a, uint nb_rows, uint nb_cols,
+                           bool wrapping, bool diagadj);
+
+/**
+ * @brief Duplicates a game in an arena
+ * @details Same as game_copy, but the copy is released with the arena, and
+ * only its histories are allocated on the heap (see game_new_empty_ext_in).
+ * @param a the arena, or NULL to allocate the copy on the heap
+ * @param g the game to copy
+ * @return the copy of the game
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+game game_copy_in(arena *a, cgame g);
@@ -2,39 +2,122 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "arena.h"
 #include "extra_functions.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_scan.h"
 #include "queue.h"
 
+enum {
+  BLOCK_SIZE = 64 /**< bytes of squares in a block, at least one line */
+};
+
+/**
+ * @brief Consecutive lines of the squares of a game: rows in row-major order,
+ * or columns in column-major order.
+ * @details A block is shared by the copies of a game until one of them writes
+ * in it, and is then duplicated for that game (copy-on-write).
+ **/
+typedef struct {
+  int nb_refs;            // number of grids that use the block
+  unsigned char cells[];  // the squares of the lines
+} block;
+
+/**
+ * @brief The expected numbers of tents and the squares of a game.
+ * @details It is shared by the copies of a game until one of them changes it.
+ * The structure is followed by the start of each row and of each column (in
+ * the blocks), then by the row blocks and the column blocks, and finally by
+ * the row clues, the column clues, the numbers of tents of the rows and of
+ * the columns, and the numbers of empty squares of the rows and of the
+ * columns. Use the macros below to reach them.
+ **/
+typedef struct {
+  int nb_refs;             // number of games that use the grid
+  uint nb_tents;           // number of tents in the grid
+  uint nb_expected_tents;  // sum of the row clues
+  unsigned char *lines[];  // nb_rows rows, then nb_cols columns
+} grid;
+
 /**
  * @brief The structure that stores the game state.
+ * @details Copying a game only shares its grid, and the blocks of squares are
+ * duplicated when they are written, so a copy costs the same whatever the
+ * size of the game, and only the blocks that change take memory.
  **/
 struct game_s {
   uint nb_rows;
   uint nb_cols;
-  square *squares;
-  uint *nb_tents_row;
-  uint *nb_tents_col;
   bool wrapping;
   bool diagadj;
   queue *undo_hist;
   queue *redo_hist;
+  arena *owner;  // arena the game was allocated in, or NULL for the heap
+  uint rows_per_block;
+  uint cols_per_block;
+  uint nb_row_blocks;
+  uint nb_col_blocks;
+  grid *grid;
+  unsigned char *losing;  // losing flags of the squares, NULL if not tracked
 };
 
+/* Parts of the grid of a game */
+#define ROW(g, i) ((g)->grid->lines[(i)])
+#define COL(g, j) ((g)->grid->lines[(g)->nb_rows + (j)])
+#define NB_BLOCKS(g) ((g)->nb_row_blocks + (g)->nb_col_blocks)
+#define BLOCKS(g) ((block **)((g)->grid->lines + (g)->nb_rows + (g)->nb_cols))
+#define ROW_CLUES(g) ((uint *)(BLOCKS(g) + NB_BLOCKS(g)))
+#define COL_CLUES(g) (ROW_CLUES(g) + (g)->nb_rows)
+#define ROW_TENTS(g) (COL_CLUES(g) + (g)->nb_cols)
+#define COL_TENTS(g) (ROW_TENTS(g) + (g)->nb_rows)
+#define ROW_EMPTIES(g) (COL_TENTS(g) + (g)->nb_cols)
+#define COL_EMPTIES(g) (ROW_EMPTIES(g) + (g)->nb_rows)
+
+/* Size of the grid of a game */
+#define GRID_SIZE(g)                                                    \
+  (sizeof(grid) +                                                       \
+   sizeof(unsigned char *) * ((g)->nb_rows + (g)->nb_cols) +            \
+   sizeof(block *) * NB_BLOCKS(g) +                                     \
+   sizeof(uint) * 3 * ((g)->nb_rows + (g)->nb_cols))
+
 struct move {
   square s;
   uint i;
   uint j;
+  bool grouped;  // undone and redone along with the move under it in history
 };
 /**
  * @brief The structure that stores the move.
  **/
 typedef struct move move;
 
+/* Number of calls to game_check_move, see game_nb_check_moves */
+static unsigned long nb_check_moves = 0;
+
 // Declaration of the functions that aren't given in the .h files
 static move *create_move(square s, uint i, uint j);
 static void free_Moves(queue *queue);
+static void *game_alloc(arena *a, size_t size);
+static void game_free_history(void *g);
+static void ref_take(int *nb_refs);
+static bool ref_drop(int *nb_refs);
+static bool ref_shared(const int *nb_refs);
+static void game_free(arena *a, void *p);
+static block *block_new(arena *a, size_t size);
+static size_t block_size(cgame g, uint index);
+static void grid_new(game g);
+static void grid_copy(game g_copy, cgame g);
+static void grid_release(game g);
+static void grid_own(game g);
+static void block_own(game g, uint index);
+static void write_square(game g, uint i, uint j, square s);
+static void write_row_clue(game g, uint i, uint nb_tents);
+static uint adjacent_cells(cgame g, uint i, uint j, bool diagonals,
+                           uint *cells);
+static bool is_losing_around(cgame g, uint i, uint j);
+static void update_losing_around(game g, uint i, uint j);
 
 /**
  * @brief stores a move in a structure allocated dynamically.
@@ -53,6 +136,7 @@ move *create_move(square s, uint i, uint j) {
   Move->s = s;
   Move->i = i;
   Move->j = j;
+  Move->grouped = false;
   return Move;
 }
 
@@ -72,6 +156,414 @@ void free_Moves(queue *queue) {
   }
 }
 
+/**
+ * @brief Allocates a block of memory for a game
+ * @param a the arena, or NULL to allocate on the heap
+ * @param size the size of the block in bytes
+ * @return the block, that exits the program if there isn't enough memory
+ **/
+void *game_alloc(arena *a, size_t size) {
+  if (a != NULL) {
+    return arena_alloc(a, size);
+  }
+  void *block = malloc(size);
+  if (block == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  return block;
+}
+
+/**
+ * @brief Frees a block of memory of a game
+ * @param a the arena it was allocated in, or NULL for the heap
+ * @param p the block, that is only freed if it is on the heap (the arena
+ * releases its blocks all at once)
+ **/
+void game_free(arena *a, void *p) {
+  if (a == NULL) {
+    free(p);
+  }
+}
+
+/**
+ * @brief Frees the undo and redo histories of a game, and lets go of its grid
+ * @details The histories live on the heap even for a game allocated in an
+ * arena, so this is called when the arena is deleted.
+ * @param g the game
+ **/
+void game_free_history(void *g) {
+  game g_hist = (game)g;
+  free_Moves(g_hist->undo_hist);
+  free(g_hist->undo_hist);
+  free_Moves(g_hist->redo_hist);
+  free(g_hist->redo_hist);
+  grid_release(g_hist);
+  game_free(g_hist->owner, g_hist->losing);
+}
+
+/**
+ * @brief Counts one more user of a grid or of a block
+ * @details The counts are atomic, since the copies of a game may be used by
+ * different threads.
+ * @param nb_refs the count
+ **/
+void ref_take(int *nb_refs) {
+#ifdef __GNUC__
+  __atomic_add_fetch(nb_refs, 1, __ATOMIC_RELAXED);
+#else
+  (*nb_refs)++;
+#endif
+}
+
+/**
+ * @brief Counts one less user of a grid or of a block
+ * @param nb_refs the count
+ * @return true if it was the last one, which must then free it
+ **/
+bool ref_drop(int *nb_refs) {
+#ifdef __GNUC__
+  return __atomic_sub_fetch(nb_refs, 1, __ATOMIC_ACQ_REL) == 0;
+#else
+  return --(*nb_refs) == 0;
+#endif
+}
+
+/**
+ * @brief Tells if a grid or a block has other users
+ * @param nb_refs the count
+ * @return true if it is shared, and must be duplicated before being written
+ **/
+bool ref_shared(const int *nb_refs) {
+#ifdef __GNUC__
+  return __atomic_load_n(nb_refs, __ATOMIC_ACQUIRE) > 1;
+#else
+  return *nb_refs > 1;
+#endif
+}
+
+/**
+ * @brief Allocates a block of empty squares, used by nobody yet
+ * @param a the arena of the game, or NULL for the heap
+ * @param size the number of squares
+ * @return the block
+ **/
+block *block_new(arena *a, size_t size) {
+  block *b = (block *)game_alloc(a, sizeof(block) + size);
+  b->nb_refs = 1;
+  memset(b->cells, EMPTY, size);
+  return b;
+}
+
+/**
+ * @brief Gives the number of squares of a block of a game
+ * @param g the game
+ * @param index index of the block, among the row blocks then the column blocks
+ * @return the size of the block
+ **/
+size_t block_size(cgame g, uint index) {
+  if (index < g->nb_row_blocks) {
+    return (size_t)g->rows_per_block * g->nb_cols;
+  }
+  return (size_t)g->cols_per_block * g->nb_rows;
+}
+
+/**
+ * @brief Gives a new grid to a game, whose squares are empty and whose
+ * numbers of tents are 0
+ * @details The lines are grouped in blocks of about BLOCK_SIZE squares. The
+ * grid and its blocks are allocated where the game is.
+ * @param g the game, whose size and owner are set
+ **/
+void grid_new(game g) {
+  g->rows_per_block = g->nb_cols >= BLOCK_SIZE ? 1 : BLOCK_SIZE / g->nb_cols;
+  if (g->rows_per_block > g->nb_rows) {
+    g->rows_per_block = g->nb_rows;
+  }
+  g->cols_per_block = g->nb_rows >= BLOCK_SIZE ? 1 : BLOCK_SIZE / g->nb_rows;
+  if (g->cols_per_block > g->nb_cols) {
+    g->cols_per_block = g->nb_cols;
+  }
+  g->nb_row_blocks = (g->nb_rows + g->rows_per_block - 1) / g->rows_per_block;
+  g->nb_col_blocks = (g->nb_cols + g->cols_per_block - 1) / g->cols_per_block;
+  g->grid = (grid *)game_alloc(g->owner, GRID_SIZE(g));
+  g->grid->nb_refs = 1;
+  g->grid->nb_tents = 0;
+  g->grid->nb_expected_tents = 0;
+  memset(ROW_CLUES(g), 0, sizeof(uint) * 2 * (g->nb_rows + g->nb_cols));
+  for (uint i = 0; i < g->nb_rows; i++) {
+    ROW_EMPTIES(g)[i] = g->nb_cols;
+  }
+  for (uint j = 0; j < g->nb_cols; j++) {
+    COL_EMPTIES(g)[j] = g->nb_rows;
+  }
+  for (uint k = 0; k < g->nb_row_blocks; k++) {
+    BLOCKS(g)[k] = block_new(g->owner, block_size(g, k));
+    for (uint i = k * g->rows_per_block;
+         i < (k + 1) * g->rows_per_block && i < g->nb_rows; i++) {
+      ROW(g, i) = BLOCKS(g)[k]->cells + (i % g->rows_per_block) * g->nb_cols;
+    }
+  }
+  for (uint k = 0; k < g->nb_col_blocks; k++) {
+    BLOCKS(g)[g->nb_row_blocks + k] =
+        block_new(g->owner, block_size(g, g->nb_row_blocks + k));
+    for (uint j = k * g->cols_per_block;
+         j < (k + 1) * g->cols_per_block && j < g->nb_cols; j++) {
+      COL(g, j) = BLOCKS(g)[g->nb_row_blocks + k]->cells +
+                  (j % g->cols_per_block) * g->nb_rows;
+    }
+  }
+}
+
+/**
+ * @brief Lets go of the grid of a game, which is freed if it was the last user
+ * @param g the game
+ **/
+void grid_release(game g) {
+  if (!ref_drop(&g->grid->nb_refs)) {
+    return;
+  }
+  for (uint k = 0; k < NB_BLOCKS(g); k++) {
+    if (ref_drop(&BLOCKS(g)[k]->nb_refs)) {
+      game_free(g->owner, BLOCKS(g)[k]);
+    }
+  }
+  game_free(g->owner, g->grid);
+}
+
+/**
+ * @brief Gives a game a grid of its own, equal to the one of another game
+ * @details The grids of games that aren't allocated in the same place can't
+ * be shared, since one may be released before the other.
+ * @param g_copy the copy, whose size and owner are set
+ * @param g the game
+ **/
+void grid_copy(game g_copy, cgame g) {
+  grid_new(g_copy);
+  g_copy->grid->nb_tents = g->grid->nb_tents;
+  g_copy->grid->nb_expected_tents = g->grid->nb_expected_tents;
+  memcpy(ROW_CLUES(g_copy), ROW_CLUES(g),
+         sizeof(uint) * 3 * (g->nb_rows + g->nb_cols));
+  for (uint k = 0; k < NB_BLOCKS(g); k++) {
+    memcpy(BLOCKS(g_copy)[k]->cells, BLOCKS(g)[k]->cells, block_size(g, k));
+  }
+}
+
+/**
+ * @brief Makes sure that a game is the only user of its grid
+ * @details A shared grid is duplicated, and the copy shares the blocks.
+ * @param g the game
+ **/
+void grid_own(game g) {
+  if (!ref_shared(&g->grid->nb_refs)) {
+    return;
+  }
+  grid *shared = g->grid;
+  size_t size = GRID_SIZE(g);
+  g->grid = (grid *)game_alloc(g->owner, size);
+  memcpy(g->grid, shared, size);
+  g->grid->nb_refs = 1;
+  for (uint k = 0; k < NB_BLOCKS(g); k++) {
+    ref_take(&BLOCKS(g)[k]->nb_refs);
+  }
+  if (ref_drop(&shared->nb_refs)) {
+    // the other users have let go of it in the meantime
+    for (uint k = 0; k < NB_BLOCKS(g); k++) {
+      ref_drop(&BLOCKS(g)[k]->nb_refs);
+    }
+    game_free(g->owner, shared);
+  }
+}
+
+/**
+ * @brief Makes sure that a game is the only user of one of its blocks
+ * @param g the game, that is the only user of its grid
+ * @param index index of the block, among the row blocks then the column blocks
+ **/
+void block_own(game g, uint index) {
+  block *shared = BLOCKS(g)[index];
+  if (!ref_shared(&shared->nb_refs)) {
+    return;
+  }
+  bool is_row_block = index < g->nb_row_blocks;
+  uint per_block = is_row_block ? g->rows_per_block : g->cols_per_block;
+  uint len = is_row_block ? g->nb_cols : g->nb_rows;
+  uint nb_lines = is_row_block ? g->nb_rows : g->nb_cols;
+  uint first = (is_row_block ? index : index - g->nb_row_blocks) * per_block;
+  unsigned char **lines = is_row_block ? &ROW(g, 0) : &COL(g, 0);
+  block *own = block_new(g->owner, block_size(g, index));
+  memcpy(own->cells, shared->cells, block_size(g, index));
+  BLOCKS(g)[index] = own;
+  for (uint k = first; k < first + per_block && k < nb_lines; k++) {
+    lines[k] = own->cells + (k - first) * len;
+  }
+  if (ref_drop(&shared->nb_refs)) {
+    game_free(g->owner, shared);
+  }
+}
+
+/**
+ * @brief Writes a square, in the row and in the column where it is stored
+ * @details The numbers of tents and of empty squares are updated along with
+ * it, and so are the losing flags of the squares around if the game tracks
+ * them.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @param s the square
+ **/
+void write_square(game g, uint i, uint j, square s) {
+  square old = (square)ROW(g, i)[j];
+  if (old == s) {
+    return;  // nothing to duplicate
+  }
+  grid_own(g);
+  block_own(g, i / g->rows_per_block);
+  block_own(g, g->nb_row_blocks + j / g->cols_per_block);
+  ROW(g, i)[j] = s;
+  COL(g, j)[i] = s;
+  int tents = (s == TENT) - (old == TENT);
+  int empties = (s == EMPTY) - (old == EMPTY);
+  g->grid->nb_tents += tents;
+  ROW_TENTS(g)[i] += tents;
+  COL_TENTS(g)[j] += tents;
+  ROW_EMPTIES(g)[i] += empties;
+  COL_EMPTIES(g)[j] += empties;
+  if (g->losing != NULL) {
+    update_losing_around(g, i, j);
+  }
+}
+
+/**
+ * @brief Writes the expected number of tents of a row
+ * @param g the game, that is the only user of its grid
+ * @param i row index
+ * @param nb_tents the expected number of tents
+ **/
+void write_row_clue(game g, uint i, uint nb_tents) {
+  g->grid->nb_expected_tents += nb_tents - ROW_CLUES(g)[i];
+  ROW_CLUES(g)[i] = nb_tents;
+}
+
+/**
+ * @brief Gives the cells adjacent to a cell, like
+ * make_array_of_all_adjacent_cells and make_array_of_ortho_adjacent_cells but
+ * without allocating
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @param diagonals true to include the diagonally adjacent cells
+ * @param cells an array of at least 16 uint, filled with the row and the
+ * column of each adjacent cell
+ * @return the number of adjacent cells
+ **/
+uint adjacent_cells(cgame g, uint i, uint j, bool diagonals, uint *cells) {
+  static const int moves[8][2] = {{0, -1}, {-1, 0}, {0, 1},  {1, 0},
+                                  {-1, -1}, {-1, 1}, {1, 1}, {1, -1}};
+  uint nb_cells = 0;
+  for (uint k = 0; k < (diagonals ? 8u : 4u); k++) {
+    uint cell_i = i + moves[k][0];
+    uint cell_j = j + moves[k][1];
+    if (cell_i >= g->nb_rows || cell_j >= g->nb_cols) {
+      if (!g->wrapping) {
+        continue;
+      }
+      // the cells out of the grid are on the other side
+      if (cell_i >= g->nb_rows) {
+        cell_i = cell_i == g->nb_rows ? 0 : g->nb_rows - 1;
+      }
+      if (cell_j >= g->nb_cols) {
+        cell_j = cell_j == g->nb_cols ? 0 : g->nb_cols - 1;
+      }
+    }
+    cells[2 * nb_cells] = cell_i;
+    cells[2 * nb_cells + 1] = cell_j;
+    nb_cells++;
+  }
+  return nb_cells;
+}
+
+/**
+ * @brief Tells if a square breaks one of the rules that only look at the
+ * squares around it
+ * @details These are the rules of game_check_move about the tents that are
+ * adjacent to a tent, the trees around a tent, and the trees surrounded by
+ * grass. The rules about the numbers of tents are checked by
+ * game_is_losing_square.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @return true if the square is a tent or grass that breaks one of them
+ **/
+bool is_losing_around(cgame g, uint i, uint j) {
+  uint cells[16];
+  square s = (square)ROW(g, i)[j];
+  if (s == TENT) {
+    uint nb_cells = adjacent_cells(g, i, j, !g->diagadj, cells);
+    for (uint k = 0; k < nb_cells; k++) {
+      if (ROW(g, cells[2 * k])[cells[2 * k + 1]] == TENT) {
+        return true;
+      }
+    }
+    nb_cells = adjacent_cells(g, i, j, false, cells);
+    for (uint k = 0; k < nb_cells; k++) {
+      if (ROW(g, cells[2 * k])[cells[2 * k + 1]] == TREE) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (s == GRASS) {
+    uint nb_cells = adjacent_cells(g, i, j, false, cells);
+    for (uint k = 0; k < nb_cells; k++) {
+      if (ROW(g, cells[2 * k])[cells[2 * k + 1]] != TREE) {
+        continue;
+      }
+      uint cells_tree[16];
+      uint nb_cells_tree =
+          adjacent_cells(g, cells[2 * k], cells[2 * k + 1], false, cells_tree);
+      uint nb_filled = 0;
+      for (uint l = 0; l < nb_cells_tree; l++) {
+        square around =
+            (square)ROW(g, cells_tree[2 * l])[cells_tree[2 * l + 1]];
+        nb_filled += around == GRASS || around == TREE;
+      }
+      if (nb_filled == nb_cells_tree) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Updates the losing flags of the squares around a square that changed
+ * @details The flag of a square only depends on the squares at most 2 rows and
+ * 2 columns away from it (the trees next to it and their own neighbours).
+ * @param g the game, that tracks its losing squares
+ * @param i row index of the square that changed
+ * @param j column index of the square that changed
+ **/
+void update_losing_around(game g, uint i, uint j) {
+  for (int di = -2; di <= 2; di++) {
+    uint a = i + di;
+    if (g->wrapping) {
+      a = (i + 2 * g->nb_rows + di) % g->nb_rows;
+    } else if (a >= g->nb_rows) {
+      continue;
+    }
+    for (int dj = -2; dj <= 2; dj++) {
+      uint b = j + dj;
+      if (g->wrapping) {
+        b = (j + 2 * g->nb_cols + dj) % g->nb_cols;
+      } else if (b >= g->nb_cols) {
+        continue;
+      }
+      g->losing[a * g->nb_cols + b] = is_losing_around(g, a, b);
+    }
+  }
+}
+
 game game_new(square *squares, uint *nb_tents_row, uint *nb_tents_col) {
   // if the space of the game wasn't make then the game call an error//
   if (squares == NULL || nb_tents_row == NULL || nb_tents_col == NULL) {
@@ -81,77 +573,41 @@ game game_new(square *squares, uint *nb_tents_row, uint *nb_tents_col) {
   game g = game_new_empty();
   // put the square in the game//
   for (uint i = 0; i < DEFAULT_SIZE * DEFAULT_SIZE; i++) {
-    g->squares[i] = squares[i];
+    write_square(g, i / DEFAULT_SIZE, i % DEFAULT_SIZE, squares[i]);
   }
   // put the corresponding objects to all the square//
   for (uint i = 0; i < DEFAULT_SIZE; i++) {
-    g->nb_tents_col[i] = nb_tents_col[i];
-    g->nb_tents_row[i] = nb_tents_row[i];
+    COL_CLUES(g)[i] = nb_tents_col[i];
+    write_row_clue(g, i, nb_tents_row[i]);
   }
   return g;
 }
 
 game game_new_empty(void) {
-  // create a new memory space//
-  game g = (game)malloc(sizeof(struct game_s));
-  // if the memory space wasn't create then call an error//
-  if (g == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  // create a new memory space for each square//
-  g->squares = (square *)malloc(sizeof(square) * DEFAULT_SIZE * DEFAULT_SIZE);
-  if (g->squares == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  // create a new memory space for each number of tents in columns//
-  g->nb_tents_col = (uint *)malloc(sizeof(uint) * DEFAULT_SIZE);
-  if (g->nb_tents_col == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  // create a new memory space for each number of rows//
-  g->nb_tents_row = (uint *)malloc(sizeof(uint) * DEFAULT_SIZE);
-  if (g->nb_tents_row == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  g->nb_rows = DEFAULT_SIZE;
-  g->nb_cols = DEFAULT_SIZE;
-  g->wrapping = false;
-  g->diagadj = false;
-  g->undo_hist = queue_new();
-  g->redo_hist = queue_new();
-  // put all the expected tents in the game for each column and each row//
-  for (int i = 0; i < DEFAULT_SIZE; i++) {
-    game_set_expected_nb_tents_row(g, i, 0);
-    game_set_expected_nb_tents_col(g, i, 0);
-    for (int j = 0; j < DEFAULT_SIZE; j++) {
-      game_set_square(g, i, j, EMPTY);
-    }
-  }
-  return g;
+  return game_new_empty_ext(DEFAULT_SIZE, DEFAULT_SIZE, false, false);
 }
 
-game game_copy(cgame g) {
+game game_copy(cgame g) { return game_copy_in(NULL, g); }
+
+game game_copy_in(arena *a, cgame g) {
   // if the game doesn't exist then call an error//
   test_pointer(g);
-  game g_copy = game_new_empty_ext(game_nb_rows(g), game_nb_cols(g),
-                                   game_is_wrapping(g), game_is_diagadj(g));
-  for (uint i = 0; i < game_nb_rows(g); i++) {
-    uint nb_r = game_get_expected_nb_tents_row(g, i);
-    game_set_expected_nb_tents_row(g_copy, i, nb_r);
-  }
-  for (uint j = 0; j < game_nb_cols(g); j++) {
-    uint nb_c = game_get_expected_nb_tents_col(g, j);
-    game_set_expected_nb_tents_col(g_copy, j, nb_c);
+  // the grid is shared until one of the games changes it, only the histories
+  // are the copy's own (a grid is only shared by games allocated in the same
+  // place), and the copy doesn't track its losing squares
+  game g_copy = (game)game_alloc(a, sizeof(struct game_s));
+  memcpy(g_copy, g, sizeof(struct game_s));
+  g_copy->owner = a;
+  if (a == g->owner) {
+    ref_take(&g->grid->nb_refs);
+  } else {
+    grid_copy(g_copy, g);
   }
-  for (uint i = 0; i < game_nb_rows(g); i++) {
-    for (uint j = 0; j < game_nb_cols(g); j++) {
-      square s = game_get_square(g, i, j);
-      game_set_square(g_copy, i, j, s);
-    }
+  g_copy->undo_hist = queue_new();
+  g_copy->redo_hist = queue_new();
+  g_copy->losing = NULL;
+  if (a != NULL) {
+    arena_on_delete(a, game_free_history, g_copy);
   }
   return g_copy;
 }
@@ -172,20 +628,24 @@ bool game_equal(cgame g1, cgame g2) {
   }
   // for a specific row, if g1 is different of g2 then its false//
   for (uint i = 0; i < game_nb_rows(g1); i++) {
-    if (g1->nb_tents_row[i] != g2->nb_tents_row[i]) {
+    if (ROW_CLUES(g1)[i] != ROW_CLUES(g2)[i]) {
       return false;
     }
   }
   // for a specific column, if g1 is different of g2 then its false//
   for (uint j = 0; j < game_nb_cols(g1); j++) {
-    if (g1->nb_tents_col[j] != g2->nb_tents_col[j]) {
+    if (COL_CLUES(g1)[j] != COL_CLUES(g2)[j]) {
       return false;
     }
   }
   // for all the game if a square of g1 is different of a square of g2 then its
-  // false//
-  for (uint i = 0; i < game_nb_rows(g1) * game_nb_cols(g2); i++) {
-    if (g1->squares[i] != g2->squares[i]) {
+  // false (the rows that are shared by the copies of a game are equal)//
+  if (g1->grid == g2->grid) {
+    return true;
+  }
+  for (uint i = 0; i < game_nb_rows(g1); i++) {
+    if (ROW(g1, i) != ROW(g2, i) &&
+        memcmp(ROW(g1, i), ROW(g2, i), g1->nb_cols) != 0) {
       return false;
     }
   }
@@ -193,15 +653,11 @@ bool game_equal(cgame g1, cgame g2) {
 }
 
 void game_delete(game g) {
-  if (g != NULL) {
-    free(g->nb_tents_col);
-    free(g->nb_tents_row);
-    free(g->squares);
-    free_Moves(g->undo_hist);
-    free(g->undo_hist);
-    free_Moves(g->redo_hist);
-    free(g->redo_hist);
+  // a game allocated in an arena is released with its arena
+  if (g == NULL || g->owner != NULL) {
+    return;
   }
+  game_free_history(g);
   free(g);
 }
 
@@ -213,38 +669,88 @@ void game_set_square(game g, uint i, uint j, square s) {
   }
   test_i_value(g, i);
   test_j_value(g, j);
-  g->squares[j + i * game_nb_cols(g)] = s;
+  write_square(g, i, j, s);
 }
 
 square game_get_square(cgame g, uint i, uint j) {
   test_pointer(g);
   test_i_value(g, i);
   test_j_value(g, j);
-  return g->squares[j + i * game_nb_cols(g)];
+  return (square)ROW(g, i)[j];
+}
+
+bool game_is_losing_square(cgame g, uint i, uint j) {
+  test_pointer(g);
+  test_i_value(g, i);
+  test_j_value(g, j);
+  // the flags of a game that tracks them are kept up to date by write_square,
+  // the others are read from the squares around; the numbers of tents of the
+  // row, of the column and of the grid are checked here
+  square s = (square)ROW(g, i)[j];
+  bool around = g->losing != NULL ? g->losing[i * g->nb_cols + j]
+                                  : is_losing_around(g, i, j);
+  if (s == TENT) {
+    return around || ROW_TENTS(g)[i] > ROW_CLUES(g)[i] ||
+           COL_TENTS(g)[j] > COL_CLUES(g)[j] ||
+           g->grid->nb_tents > g->grid->nb_expected_tents;
+  }
+  if (s == GRASS) {
+    return around ||
+           ROW_CLUES(g)[i] - ROW_TENTS(g)[i] > ROW_EMPTIES(g)[i] ||
+           COL_CLUES(g)[j] - COL_TENTS(g)[j] > COL_EMPTIES(g)[j];
+  }
+  return false;
+}
+
+void game_track_losing_squares(game g) {
+  test_pointer(g);
+  if (g->losing == NULL) {
+    g->losing =
+        (unsigned char *)game_alloc(g->owner, (size_t)g->nb_rows * g->nb_cols);
+  }
+  for (uint i = 0; i < g->nb_rows; i++) {
+    for (uint j = 0; j < g->nb_cols; j++) {
+      g->losing[i * g->nb_cols + j] = is_losing_around(g, i, j);
+    }
+  }
+}
+
+const unsigned char *game_row_squares(cgame g, uint i) {
+  test_pointer(g);
+  test_i_value(g, i);
+  return ROW(g, i);
+}
+
+const unsigned char *game_col_squares(cgame g, uint j) {
+  test_pointer(g);
+  test_j_value(g, j);
+  return COL(g, j);
 }
 
 void game_set_expected_nb_tents_row(game g, uint i, uint nb_tents) {
   test_pointer(g);
   test_i_value(g, i);
-  g->nb_tents_row[i] = nb_tents;
+  grid_own(g);
+  write_row_clue(g, i, nb_tents);
 }
 
 void game_set_expected_nb_tents_col(game g, uint j, uint nb_tents) {
   test_pointer(g);
   test_j_value(g, j);
-  g->nb_tents_col[j] = nb_tents;
+  grid_own(g);
+  COL_CLUES(g)[j] = nb_tents;
 }
 
 uint game_get_expected_nb_tents_row(cgame g, uint i) {
   test_pointer(g);
   test_i_value(g, i);
-  return g->nb_tents_row[i];
+  return ROW_CLUES(g)[i];
 }
 
 uint game_get_expected_nb_tents_col(cgame g, uint j) {
   test_pointer(g);
   test_j_value(g, j);
-  return g->nb_tents_col[j];
+  return COL_CLUES(g)[j];
 }
 
 uint game_get_expected_nb_tents_all(cgame g) {
@@ -255,7 +761,7 @@ uint game_get_expected_nb_tents_all(cgame g) {
   // it could also be done by checking the array of expected number of tents for
   // each column instead.
   for (uint i = 0; i < game_nb_rows(g); i++) {
-    tents += g->nb_tents_row[i];
+    tents += ROW_CLUES(g)[i];
   }
   return tents;
 }
@@ -263,33 +769,15 @@ uint game_get_expected_nb_tents_all(cgame g) {
 uint game_get_current_nb_tents_row(cgame g, uint i) {
   test_pointer(g);
   test_i_value(g, i);
-  // setting a counter for the amount of tents.
-  uint tents = 0;
-  // checking each square of the row.
-  for (int j = 0; j < game_nb_cols(g); j++) {
-    // if the square is a tent then increase the counter by 1, otherwise the
-    // counter is unchanged.
-    if (game_get_square(g, i, j) == TENT) {
-      tents++;
-    }
-  }
-  return tents;
+  // the squares of the row are contiguous, so they are counted all at once
+  return scan_count(ROW(g, i), g->nb_cols, TENT);
 }
 
 uint game_get_current_nb_tents_col(cgame g, uint j) {
   test_pointer(g);
   test_j_value(g, j);
-  // setting a counter for the amount of tents.
-  uint tents = 0;
-  // checking each square of the row.
-  for (int i = 0; i < game_nb_rows(g); i++) {
-    // if the square is a tent then increase the counter by 1, otherwise the
-    // counter is unchanged.
-    if (game_get_square(g, i, j) == TENT) {
-      tents++;
-    }
-  }
-  return tents;
+  // the column-major copy makes the squares of the column contiguous
+  return scan_count(COL(g, j), g->nb_rows, TENT);
 }
 
 uint game_get_current_nb_tents_all(cgame g) {
@@ -323,8 +811,40 @@ void game_play_move(game g, uint i, uint j, square s) {
   free_Moves(g->redo_hist);
 }
 
+void game_play_solution(game g, cgame solution) {
+  test_pointer(g);
+  test_pointer(solution);
+  if (g->nb_rows != solution->nb_rows || g->nb_cols != solution->nb_cols) {
+    fprintf(stderr, "The games don't have the same size\n");
+    exit(EXIT_FAILURE);
+  }
+  bool first = true;
+  for (uint k = 0; k < g->nb_rows * g->nb_cols; k++) {
+    uint i = k / g->nb_cols;
+    uint j = k % g->nb_cols;
+    square s = (square)ROW(solution, i)[j];
+    if (s == ROW(g, i)[j] || s == TREE || ROW(g, i)[j] == TREE) {
+      continue;
+    }
+    move *move = create_move(game_get_square(g, i, j), i, j);
+    move->grouped = !first;
+    first = false;
+    queue_push_head(g->undo_hist, move);
+    game_set_square(g, i, j, s);
+  }
+  if (!first) {
+    free_Moves(g->redo_hist);
+  }
+}
+
 int game_check_move(cgame g, uint i, uint j, square s) {
   test_pointer(g);
+#ifdef __GNUC__
+  // the games may be checked by several threads (solver, daemon workers)
+  __atomic_add_fetch(&nb_check_moves, 1, __ATOMIC_RELAXED);
+#else
+  nb_check_moves++;
+#endif
   test_i_value(g, i);
   test_j_value(g, j);
   if (s != EMPTY && s != GRASS && s != TENT && s != TREE) {
@@ -411,18 +931,8 @@ int game_check_move(cgame g, uint i, uint j, square s) {
 
   if (s == GRASS) {
     // placing grass and not enough empty spaces for tents is losing
-    uint nb_empty_row = 0;
-    uint nb_empty_col = 0;
-    for (uint b = 0; b < game_nb_cols(g); b++) {
-      if (game_get_square(g, i, b) == EMPTY) {
-        nb_empty_row++;
-      }
-    }
-    for (uint a = 0; a < game_nb_rows(g); a++) {
-      if (game_get_square(g, a, j) == EMPTY) {
-        nb_empty_col++;
-      }
-    }
+    uint nb_empty_row = scan_count(ROW(g, i), g->nb_cols, EMPTY);
+    uint nb_empty_col = scan_count(COL(g, j), g->nb_rows, EMPTY);
     if (game_get_square(g, i, j) == EMPTY) {
       nb_empty_col--;
       nb_empty_row--;
@@ -625,14 +1135,16 @@ bool game_is_over(cgame g) {
 void game_fill_grass_row(game g, uint i) {
   test_pointer(g);
   test_i_value(g, i);
-  for (uint j = 0; j < game_nb_cols(g); j++) {
-    if (game_get_square(g, i, j) == EMPTY) {
-      move *move = create_move(game_get_square(g, i, j), i, j);
-      queue_push_head(g->undo_hist,
-                      move);  // We add the move to the undo history
-      game_set_square(g, i, j,
-                      GRASS);  // fill all the empty squares in row i with grass
-    }
+  // we jump from one empty square to the next one (the row moves when its
+  // block is duplicated, so it is read again after each square)
+  uint j = scan_find(ROW(g, i), g->nb_cols, EMPTY);
+  while (j < g->nb_cols) {
+    move *move = create_move(EMPTY, i, j);
+    queue_push_head(g->undo_hist,
+                    move);  // We add the move to the undo history
+    game_set_square(g, i, j,
+                    GRASS);  // fill all the empty squares in row i with grass
+    j += 1 + scan_find(ROW(g, i) + j + 1, g->nb_cols - j - 1, EMPTY);
   }
   free_Moves(g->redo_hist);
 }
@@ -640,14 +1152,16 @@ void game_fill_grass_row(game g, uint i) {
 void game_fill_grass_col(game g, uint j) {
   test_pointer(g);
   test_j_value(g, j);
-  for (uint i = 0; i < game_nb_rows(g); i++) {
-    if (game_get_square(g, i, j) == EMPTY) {
-      move *move = create_move(game_get_square(g, i, j), i, j);
-      queue_push_head(g->undo_hist,
-                      move);  // We add the move to the undo history
-      game_set_square(
-          g, i, j, GRASS);  // fill all the empty squares in column j with grass
-    }
+  // we jump from one empty square to the next one (the column moves when its
+  // block is duplicated, so it is read again after each square)
+  uint i = scan_find(COL(g, j), g->nb_rows, EMPTY);
+  while (i < g->nb_rows) {
+    move *move = create_move(EMPTY, i, j);
+    queue_push_head(g->undo_hist,
+                    move);  // We add the move to the undo history
+    game_set_square(
+        g, i, j, GRASS);  // fill all the empty squares in column j with grass
+    i += 1 + scan_find(COL(g, j) + i + 1, g->nb_rows - i - 1, EMPTY);
   }
 }
 
@@ -678,40 +1192,26 @@ game game_new_ext(uint nb_rows, uint nb_cols, square *squares,
   game g = game_new_empty_ext(nb_rows, nb_cols, wrapping, diagadj);
   // and then we add all the given information
   for (uint i = 0; i < nb_rows * nb_cols; i++) {
-    g->squares[i] = squares[i];
+    write_square(g, i / nb_cols, i % nb_cols, squares[i]);
   }
   for (uint i = 0; i < nb_rows; i++) {
-    g->nb_tents_row[i] = nb_tents_row[i];
+    write_row_clue(g, i, nb_tents_row[i]);
   }
   for (uint j = 0; j < nb_cols; j++) {
-    g->nb_tents_col[j] = nb_tents_col[j];
+    COL_CLUES(g)[j] = nb_tents_col[j];
   }
   return g;
 }
 
 game game_new_empty_ext(uint nb_rows, uint nb_cols, bool wrapping,
                         bool diagadj) {
-  // We first allocate the memory for all of the arrays in the game structure
-  game g = (game)malloc(sizeof(struct game_s));
-  if (g == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  g->squares = (square *)malloc(sizeof(square) * nb_rows * nb_cols);
-  if (g->squares == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  g->nb_tents_row = (uint *)malloc(sizeof(uint) * nb_rows);
-  if (g->nb_tents_row == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
-  g->nb_tents_col = (uint *)malloc(sizeof(uint) * nb_cols);
-  if (g->nb_tents_col == NULL) {
-    fprintf(stderr, "Not enough memory!\n");
-    exit(EXIT_FAILURE);
-  }
+  return game_new_empty_ext_in(NULL, nb_rows, nb_cols, wrapping, diagadj);
+}
+
+game game_new_empty_ext_in(arena *a, uint nb_rows, uint nb_cols,
+                           bool wrapping, bool diagadj) {
+  // We first allocate the memory for the game structure
+  game g = (game)game_alloc(a, sizeof(struct game_s));
   // We then give the right values to the "simple" parameters
   g->nb_rows = nb_rows;
   g->nb_cols = nb_cols;
@@ -724,18 +1224,12 @@ game game_new_empty_ext(uint nb_rows, uint nb_cols, bool wrapping,
     fprintf(stderr, "Not enough memory!\n");
     exit(EXIT_FAILURE);
   }
-  // and finally we set, for each row and column, the right nb of tents, and the
-  // right value of squares
-  for (uint i = 0; i < nb_rows; i++) {
-    game_set_expected_nb_tents_row(g, i, 0);
-  }
-  for (uint j = 0; j < nb_cols; j++) {
-    game_set_expected_nb_tents_col(g, j, 0);
-  }
-  for (uint i = 0; i < nb_rows; i++) {
-    for (uint j = 0; j < nb_cols; j++) {
-      game_set_square(g, i, j, EMPTY);
-    }
+  // and finally the grid, whose squares are empty and whose nb of tents are 0
+  g->owner = a;
+  g->losing = NULL;
+  grid_new(g);
+  if (a != NULL) {
+    arena_on_delete(a, game_free_history, g);
   }
   return g;
 }
@@ -764,10 +1258,17 @@ void game_undo(game g) {
   if ((g == NULL) || ((g->undo_hist) == NULL) || (g->redo_hist == NULL))
     exit(EXIT_FAILURE);
 
-  if (!queue_is_empty(g->undo_hist)) {
+  // the moves played together (see game_play_solution) are undone together,
+  // and they come back grouped the other way round in the redo history
+  bool first = true;
+  bool grouped = true;
+  while (grouped && !queue_is_empty(g->undo_hist)) {
     move *UndoMove = queue_pop_head(g->undo_hist);
     move *RedoMove = create_move(game_get_square(g, UndoMove->i, UndoMove->j),
                                  UndoMove->i, UndoMove->j);
+    RedoMove->grouped = !first;
+    grouped = UndoMove->grouped;
+    first = false;
 
     queue_push_head(g->redo_hist, RedoMove);
     game_set_square(g, UndoMove->i, UndoMove->j, UndoMove->s);
@@ -781,10 +1282,15 @@ void game_redo(game g) {
   if ((g == NULL) || ((g->redo_hist) == NULL) || (g->undo_hist == NULL))
     exit(EXIT_FAILURE);
 
-  if (!queue_is_empty(g->redo_hist)) {
+  bool first = true;
+  bool grouped = true;
+  while (grouped && !queue_is_empty(g->redo_hist)) {
     move *RedoMove = queue_pop_head(g->redo_hist);
     move *UndoMove = create_move(game_get_square(g, RedoMove->i, RedoMove->j),
                                  RedoMove->i, RedoMove->j);
+    UndoMove->grouped = !first;
+    grouped = RedoMove->grouped;
+    first = false;
 
     queue_push_head(g->undo_hist, UndoMove);
     game_set_square(g, RedoMove->i, RedoMove->j, RedoMove->s);
@@ -813,4 +1319,12 @@ void test_j_value(cgame g, uint j) {
     fprintf(stderr, "column number is invalid\n");
     exit(EXIT_FAILURE);
   }
-}
\ No newline at end of file
+}
+
+unsigned long game_nb_check_moves(void) {
+#ifdef __GNUC__
+  return __atomic_load_n(&nb_check_moves, __ATOMIC_RELAXED);
+#else
+  return nb_check_moves;
+#endif
+}
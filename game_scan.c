@@ -0,0 +1,187 @@
+#include "game_scan.h"
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Declaration of the functions that aren't given in the .h files
+static uint count_trailing_zeros(uint64_t x);
+static uint64_t line_mask(const unsigned char *cells, uint len, square value);
+static uint find_cell(const unsigned char *cells, uint len, square value,
+                      bool equal);
+
+/**
+ * @brief Gives the index of the lowest bit set in a word
+ * @param x the word
+ * @return the number of zero bits below the lowest bit set
+ * @pre @p x must not be 0.
+ **/
+uint count_trailing_zeros(uint64_t x) {
+#ifdef __GNUC__
+  return (uint)__builtin_ctzll(x);
+#else
+  uint n = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * @brief Gives the cells of a (piece of) line that hold a given value as a
+ * bit mask
+ * @param cells the cells of the line
+ * @param len the number of cells, at most 64
+ * @param value the square value
+ * @return a mask whose bit k is set if and only if cells[k] is @p value
+ **/
+uint64_t line_mask(const unsigned char *cells, uint len, square value) {
+  uint64_t mask = 0;
+  uint k = 0;
+#ifdef __AVX2__
+  __m256i v32 = _mm256_set1_epi8((char)value);
+  for (; k + 32 <= len; k += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)(cells + k));
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, v32));
+    mask |= (uint64_t)m << k;
+  }
+#endif
+#ifdef __SSE2__
+  __m128i v16 = _mm_set1_epi8((char)value);
+  for (; k + 16 <= len; k += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)(cells + k));
+    uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, v16));
+    mask |= (uint64_t)m << k;
+  }
+#endif
+  for (; k < len; k++) {
+    if (cells[k] == value) {
+      mask |= (uint64_t)1 << k;
+    }
+  }
+  return mask;
+}
+
+/**
+ * @brief Finds the first cell of a line that is (or isn't) a given value
+ * @param cells the cells of the line
+ * @param len the number of cells
+ * @param value the square value
+ * @param equal true to look for @p value, false to look for anything else
+ * @return the index of the cell found, or @p len
+ **/
+uint find_cell(const unsigned char *cells, uint len, square value,
+               bool equal) {
+  uint k = 0;
+#ifdef __AVX2__
+  __m256i v32 = _mm256_set1_epi8((char)value);
+  for (; k + 32 <= len; k += 32) {
+    __m256i c = _mm256_loadu_si256((const __m256i *)(cells + k));
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, v32));
+    if (!equal) {
+      m = ~m;
+    }
+    if (m != 0) {
+      return k + count_trailing_zeros(m);
+    }
+  }
+#endif
+#ifdef __SSE2__
+  __m128i v16 = _mm_set1_epi8((char)value);
+  for (; k + 16 <= len; k += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i *)(cells + k));
+    uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, v16));
+    if (!equal) {
+      m = ~m & 0xFFFF;
+    }
+    if (m != 0) {
+      return k + count_trailing_zeros(m);
+    }
+  }
+#endif
+  for (; k < len; k++) {
+    if ((cells[k] == value) == equal) {
+      return k;
+    }
+  }
+  return len;
+}
+
+uint scan_count(const unsigned char *cells, uint len, square value) {
+  uint count = 0;
+  uint k = 0;
+  // the comparisons give -1 in each equal byte, which are summed in byte
+  // counters: they are flushed every 255 rounds, before they can overflow
+#ifdef __AVX2__
+  __m256i v32 = _mm256_set1_epi8((char)value);
+  while (k + 32 <= len) {
+    __m256i acc = _mm256_setzero_si256();
+    for (uint r = 0; r < 255 && k + 32 <= len; r++, k += 32) {
+      __m256i c = _mm256_loadu_si256((const __m256i *)(cells + k));
+      acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(c, v32));
+    }
+    uint64_t sums[4];
+    _mm256_storeu_si256((__m256i *)sums,
+                        _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+    count += sums[0] + sums[1] + sums[2] + sums[3];
+  }
+#endif
+#ifdef __SSE2__
+  __m128i v16 = _mm_set1_epi8((char)value);
+  while (k + 16 <= len) {
+    __m128i acc = _mm_setzero_si128();
+    for (uint r = 0; r < 255 && k + 16 <= len; r++, k += 16) {
+      __m128i c = _mm_loadu_si128((const __m128i *)(cells + k));
+      acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(c, v16));
+    }
+    uint64_t sums[2];
+    _mm_storeu_si128((__m128i *)sums, _mm_sad_epu8(acc, _mm_setzero_si128()));
+    count += sums[0] + sums[1];
+  }
+#endif
+  for (; k < len; k++) {
+    if (cells[k] == value) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint scan_find(const unsigned char *cells, uint len, square value) {
+  return find_cell(cells, len, value, true);
+}
+
+uint scan_find_other(const unsigned char *cells, uint len, square value) {
+  return find_cell(cells, len, value, false);
+}
+
+uint scan_placements(const unsigned char *cells, uint len) {
+  uint nb_placements = 0;
+  uint run = 0;  // size of the run of empty cells we are in
+  // the line is read 64 cells at a time, and each run is skipped at once
+  for (uint base = 0; base < len; base += 64) {
+    uint n = len - base < 64 ? len - base : 64;
+    uint64_t mask = line_mask(cells + base, n, EMPTY);
+    uint pos = 0;
+    while (pos < n) {
+      uint64_t rest = mask >> pos;
+      if (rest & 1) {
+        // the run goes on (it may have started in the previous piece)
+        uint size = ~rest == 0 ? n - pos : count_trailing_zeros(~rest);
+        run += size;
+        pos += size;
+      } else {
+        nb_placements += (run + 1) / 2;
+        run = 0;
+        pos += rest == 0 ? n - pos : count_trailing_zeros(rest);
+      }
+    }
+  }
+  return nb_placements + (run + 1) / 2;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file game_scan.h
+ * @brief Scanning kernels for rows and columns of squares.
+ * @details The squares of a line are stored one byte per cell, so they can be
+ * compared 16 (SSE2) or 32 (AVX2) at a time. Each kernel has a scalar version,
+ * used when neither instruction set is enabled at compile time.
+ *
+ **/
+
+#ifndef __GAME_SCAN_H__
+#define __GAME_SCAN_H__
+#include <stdbool.h>
+
+#include "game.h"
+
+/**
+ * @brief Counts the cells of a line that hold a given square value
+ * @param cells the cells of the line (one byte per cell)
+ * @param len the number of cells in the line
+ * @param value the square value to count
+ * @return the number of cells equal to @p value
+ **/
+uint scan_count(const unsigned char *cells, uint len, square value);
+
+/**
+ * @brief Finds the first cell of a line that holds a given square value
+ * @param cells the cells of the line (one byte per cell)
+ * @param len the number of cells in the line
+ * @param value the square value to look for
+ * @return the index of the first cell equal to @p value, or @p len if there is
+ * none
+ **/
+uint scan_find(const unsigned char *cells, uint len, square value);
+
+/**
+ * @brief Finds the first cell of a line that doesn't hold a given square value
+ * @param cells the cells of the line (one byte per cell)
+ * @param len the number of cells in the line
+ * @param value the square value to skip
+ * @return the index of the first cell different from @p value, or @p len if
+ * there is none
+ **/
+uint scan_find_other(const unsigned char *cells, uint len, square value);
+
+/**
+ * @brief Gives the number of tents that can be placed in the empty cells of a
+ * line, without any two of them being next to each other
+ * @details Each run of n empty cells can hold (n + 1) / 2 tents. The line is
+ * not cyclic: a run never goes over the end of the line.
+ * @param cells the cells of the line (one byte per cell)
+ * @param len the number of cells in the line
+ * @return the number of possible tent placements
+ **/
+uint scan_placements(const unsigned char *cells, uint len);
+
+#endif  // __GAME_SCAN_H__
@@ -36,12 +36,18 @@ int main(int argc, char* argv[]) {
   SDL_Event e;
   bool quit = false;
   while (!quit) {
-    /* manage events */
-    while (SDL_PollEvent(&e)) {
-      /* process your events */
-      quit = process(win, ren, env, &e);
-      if (quit) break;
+    /* sleep until an event comes, then handle all of the pending ones */
+    if (SDL_WaitEventTimeout(&e, wait_timeout(env))) {
+      do {
+        /* process your events */
+        quit = process(win, ren, env, &e);
+        if (quit) break;
+      } while (SDL_PollEvent(&e));
     }
+    if (quit) break;
+
+    /* the frame is only redrawn if something changed */
+    if (!needs_render(env)) continue;
 
     /* background in gray */
     SDL_SetRenderDrawColor(ren, 0xA0, 0xA0, 0xA0, 0xFF);
@@ -50,7 +56,6 @@ int main(int argc, char* argv[]) {
     /* render all what you want */
     render(win, ren, env);
     SDL_RenderPresent(ren);
-    SDL_Delay(DELAY);
   }
 
   /* clean your environment */
@@ -0,0 +1,215 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "extra_functions.h"
+#include "game.h"
+#include "game_aux.h"
+#include "game_ext.h"
+#include "game_tools.h"
+#include "graphic_mode.h"
+
+/* Headless benchmark of the SDL front-end: each level is played by replaying
+ * the clicks of its solution through process(), with a software renderer
+ * drawing into a surface, so no display is needed. The textures are counted
+ * by wrapping the SDL functions that create them at link time (see the
+ * LINK_FLAGS of game_sdl_bench in CMakeLists.txt). */
+
+#define MAX_DEFAULT_LEVELS 100 /* games/level1.tnt, games/level2.tnt... */
+
+/* statistics of the frames of a level */
+typedef struct {
+  uint nb_frames;
+  double first_ms; /* first frame of the game screen */
+  double total_ms;
+  double max_ms;
+  unsigned long nb_textures;
+  unsigned long nb_check_moves;
+} bench_stats;
+
+// Declaration of the functions that aren't given in the .h files
+SDL_Texture *__real_SDL_CreateTexture(SDL_Renderer *ren, Uint32 format,
+                                      int access, int w, int h);
+SDL_Texture *__real_SDL_CreateTextureFromSurface(SDL_Renderer *ren,
+                                                 SDL_Surface *surface);
+SDL_Texture *__real_IMG_LoadTexture(SDL_Renderer *ren, const char *file);
+static void frame(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e,
+                  bench_stats *stats);
+static void click(SDL_Window *win, SDL_Renderer *ren, Env *env, int x, int y,
+                  Uint8 button, bench_stats *stats);
+static bool click_cell(SDL_Window *win, SDL_Renderer *ren, Env *env, uint i,
+                       uint j, Uint8 button, bench_stats *stats);
+static void bench_level(SDL_Window *win, SDL_Renderer *ren, char *file);
+
+static unsigned long nb_textures = 0;
+
+SDL_Texture *__wrap_SDL_CreateTexture(SDL_Renderer *ren, Uint32 format,
+                                      int access, int w, int h) {
+  nb_textures++;
+  return __real_SDL_CreateTexture(ren, format, access, w, h);
+}
+
+SDL_Texture *__wrap_SDL_CreateTextureFromSurface(SDL_Renderer *ren,
+                                                 SDL_Surface *surface) {
+  nb_textures++;
+  return __real_SDL_CreateTextureFromSurface(ren, surface);
+}
+
+SDL_Texture *__wrap_IMG_LoadTexture(SDL_Renderer *ren, const char *file) {
+  nb_textures++;
+  return __real_IMG_LoadTexture(ren, file);
+}
+
+/* handles an event and draws the frame that follows it, as the main loop of
+ * game_sdl does */
+void frame(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e,
+           bench_stats *stats) {
+  unsigned long textures_before = nb_textures;
+  unsigned long check_moves_before = game_nb_check_moves();
+  Uint64 start = SDL_GetPerformanceCounter();
+  if (e != NULL) {
+    process(win, ren, env, e);
+  }
+  if (e == NULL || needs_render(env)) {
+    SDL_SetRenderDrawColor(ren, 0xA0, 0xA0, 0xA0, 0xFF);
+    SDL_RenderClear(ren);
+    render(win, ren, env);
+    SDL_RenderPresent(ren);
+  }
+  double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000 /
+              SDL_GetPerformanceFrequency();
+  if (stats->nb_frames == 0) {
+    stats->first_ms = ms;
+  }
+  stats->nb_frames++;
+  stats->total_ms += ms;
+  if (ms > stats->max_ms) {
+    stats->max_ms = ms;
+  }
+  stats->nb_textures += nb_textures - textures_before;
+  stats->nb_check_moves += game_nb_check_moves() - check_moves_before;
+}
+
+/* clicks somewhere in the window */
+void click(SDL_Window *win, SDL_Renderer *ren, Env *env, int x, int y,
+           Uint8 button, bench_stats *stats) {
+  SDL_Event e;
+  SDL_zero(e);
+  e.type = SDL_MOUSEBUTTONDOWN;
+  e.button.windowID = SDL_GetWindowID(win);
+  e.button.button = button;
+  e.button.state = SDL_PRESSED;
+  e.button.clicks = 1;
+  e.button.x = x;
+  e.button.y = y;
+  frame(win, ren, env, &e, stats);
+}
+
+/* clicks on a cell of the grid */
+bool click_cell(SDL_Window *win, SDL_Renderer *ren, Env *env, uint i, uint j,
+                Uint8 button, bench_stats *stats) {
+  int x, y;
+  if (!cell_center(env, i, j, &x, &y)) {
+    return false;
+  }
+  click(win, ren, env, x, y, button, stats);
+  return true;
+}
+
+/* plays a level: the play button of the home screen, then a click on each
+ * cell of its solution, a left click for a tent and a right one for grass */
+void bench_level(SDL_Window *win, SDL_Renderer *ren, char *file) {
+  game g = game_load(file);
+  game solution = game_copy(g);
+  game_restart(solution);
+  if (!game_solve(solution)) {
+    printf("%-24s no solution, skipped\n", file);
+    game_delete(g);
+    game_delete(solution);
+    return;
+  }
+  char *argv[] = {"game_sdl_bench", file, NULL};
+  Env *env = init(win, ren, 2, argv);
+  bench_stats home = {0};
+  frame(win, ren, env, NULL, &home);
+  int w, h;
+  SDL_GetWindowSize(win, &w, &h);
+  bench_stats stats = {0};
+  click(win, ren, env, w * 1 / 10 + w / 16, h * 4 / 5 + w / 32, SDL_BUTTON_LEFT,
+        &stats);
+  bool missed = false;
+  for (uint i = 0; i < game_nb_rows(g); i++) {
+    for (uint j = 0; j < game_nb_cols(g); j++) {
+      square s = game_get_square(solution, i, j);
+      if (s == TREE || s == game_get_square(g, i, j)) {
+        continue;
+      }
+      // a square that is already there is emptied first
+      if (game_get_square(g, i, j) != EMPTY) {
+        missed |= !click_cell(win, ren, env, i, j, SDL_BUTTON_LEFT, &stats);
+      }
+      missed |= !click_cell(win, ren, env, i, j,
+                            s == TENT ? SDL_BUTTON_LEFT : SDL_BUTTON_RIGHT,
+                            &stats);
+    }
+  }
+  printf("%-24s %6u %9.3f %9.3f %9.3f %9.2f %11.1f%s\n", file, stats.nb_frames,
+         stats.first_ms, stats.total_ms / stats.nb_frames, stats.max_ms,
+         (double)stats.nb_textures / stats.nb_frames,
+         (double)stats.nb_check_moves / stats.nb_frames,
+         missed ? " (cells out of view)" : "");
+  clean(win, ren, env);
+  game_delete(g);
+  game_delete(solution);
+}
+
+int main(int argc, char *argv[]) {
+  /* no display is needed */
+  SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+  if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    ERROR("Error: SDL_Init VIDEO (%s)", SDL_GetError());
+  if (IMG_Init(IMG_INIT_PNG & IMG_INIT_PNG) != IMG_INIT_PNG)
+    ERROR("Error: IMG_Init PNG (%s)", SDL_GetError());
+  if (TTF_Init() != 0) ERROR("Error: TTF_Init (%s)", SDL_GetError());
+
+  /* the window only gives its size, the frames are drawn in a surface */
+  SDL_Window *win =
+      SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED,
+                       SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT,
+                       SDL_WINDOW_HIDDEN);
+  if (!win) ERROR("Error: SDL_CreateWindow (%s)", SDL_GetError());
+  SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(
+      0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+  if (!surface) ERROR("Error: SDL_CreateRGBSurface (%s)", SDL_GetError());
+  SDL_Renderer *ren = SDL_CreateSoftwareRenderer(surface);
+  if (!ren) ERROR("Error: SDL_CreateSoftwareRenderer (%s)", SDL_GetError());
+
+  printf("%-24s %6s %9s %9s %9s %9s %11s\n", "level", "frames", "first ms",
+         "mean ms", "max ms", "tex/frame", "check/frame");
+  if (argc > 1) {
+    for (int k = 1; k < argc; k++) {
+      bench_level(win, ren, argv[k]);
+    }
+  } else {
+    for (uint k = 1; k <= MAX_DEFAULT_LEVELS; k++) {
+      char file[64];
+      sprintf(file, "games/level%u.tnt", k);
+      FILE *f = fopen(file, "r");
+      if (f == NULL) {
+        break;
+      }
+      fclose(f);
+      bench_level(win, ren, file);
+    }
+  }
+
+  SDL_DestroyRenderer(ren);
+  SDL_FreeSurface(surface);
+  SDL_DestroyWindow(win);
+  IMG_Quit();
+  TTF_Quit();
+  SDL_Quit();
+  return EXIT_SUCCESS;
+}
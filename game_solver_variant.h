@@ -0,0 +1,1285 @@
+/**
+ * @file game_solver_variant.h
+ * @brief Solver specialised for one combination of the game options.
+ * @details This file has no include guard: it is included by game_tools.c once
+ * per combination of the wrapping and diagadj options, with these macros
+ * defined:
+ * - SOLVER_WRAPPING: true if the variant solves wrapping games
+ * - SOLVER_DIAGADJ: true if the variant solves diagadj games
+ * - SOLVER_FN(name): the name given to the function @p name in this variant
+ *
+ * Since both options are known at compile time, the adjacency tests never
+ * branch on them, and the loops over the neighbourhood of a cell have a fixed
+ * shape that the compiler can unroll. The macros are undefined at the end of
+ * the file.
+ **/
+
+/* the solver only looks at the orthogonal neighbours when tents may touch
+ * diagonally, and at all of the surrounding cells otherwise */
+#define SOLVER_ADJ_STEP (SOLVER_DIAGADJ ? 2 : 1)
+
+static int SOLVER_FN(check_move)(cgame g, const neighbours *nb, uint i, uint j,
+                                 square s);
+static bool SOLVER_FN(is_over)(cgame g, const neighbours *nb);
+static uint SOLVER_FN(section_around)(cgame g, const neighbours *nb, uint i,
+                                      uint j, bool vertical, uint *p_before);
+static uint SOLVER_FN(nb_possible_tent_placements)(cgame g,
+                                                   const neighbours *nb,
+                                                   uint line, bool vertical);
+static bool SOLVER_FN(line_is_saturated)(cgame g, const neighbours *nb,
+                                         uint line, bool vertical, uint extra);
+static int SOLVER_FN(extra_check_move)(cgame g, const neighbours *nb, uint i,
+                                       uint j, square s);
+static int SOLVER_FN(check_lines_around)(cgame g, const neighbours *nb, uint i,
+                                         uint j, square s);
+static int SOLVER_FN(propagate_line)(game g, const neighbours *nb, uint line,
+                                     bool vertical);
+static int SOLVER_FN(fill)(game g, const neighbours *nb);
+static bool SOLVER_FN(conflicts)(cgame root, const neighbours *nb,
+                                 const uint *cells,
+                                 const unsigned char *squares,
+                                 uint nb_squares, uint left_out);
+static uint SOLVER_FN(distance)(uint a, uint b, uint len);
+static void SOLVER_FN(learn)(cgame root, const neighbours *nb,
+                             const uint *decided_cells,
+                             const unsigned char *decided_squares,
+                             uint nb_decided, uint cell);
+static uint SOLVER_FN(solve_rec)(game g, const neighbours *nb,
+                                 bool count_solutions, uint *p_nb_sol_found,
+                                 search_limits *limits);
+static bool SOLVER_FN(solve)(game g, const neighbours *nb,
+                             search_limits *limits);
+static uint SOLVER_FN(nb_solutions)(game g, const neighbours *nb,
+                                    search_limits *limits);
+static partial_node SOLVER_FN(partial_node_of)(cgame g, const neighbours *nb,
+                                               uint next_cell, uint nb_skipped,
+                                               bool propagate);
+static game_state *SOLVER_FN(solve_partial)(cgame g, const neighbours *nb,
+                                            search_limits *limits,
+                                            bool *p_solved);
+static bool SOLVER_FN(find_forced_square)(cgame g, const neighbours *nb,
+                                          bool extra, uint *p_i, uint *p_j,
+                                          square *p_s);
+static hint_rule SOLVER_FN(hint)(cgame g, const neighbours *nb, uint *p_i,
+                                 uint *p_j, square *p_s);
+
+/**
+ * @brief Checks if a given move in a square is regular
+ * @details Same rules as game_check_move, using the neighbour tables.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param i row index
+ * @param j column index
+ * @param s the square value
+ * @return either REGULAR, LOSING or ILLEGAL depending on the move
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+int SOLVER_FN(check_move)(cgame g, const neighbours *nb, uint i, uint j,
+                          square s) {
+  uint nb_cols = nb->nb_cols;
+  const uint *around = nb->around + (i * nb_cols + j) * 8;
+  square current = game_get_square(g, i, j);
+  // placing or replacing TREE is illegal
+  if ((s == TREE && current != TREE) || (s != TREE && current == TREE)) {
+    return ILLEGAL;
+  }
+  // placing an empty space is regular
+  if (s == EMPTY) {
+    return REGULAR;
+  }
+
+  if (s == TENT) {
+    // placing n+1 tents in column or row is losing
+    if (game_get_current_nb_tents_col(g, j) + (current != TENT) >
+        game_get_expected_nb_tents_col(g, j)) {
+      return LOSING;
+    }
+    if (game_get_current_nb_tents_row(g, i) + (current != TENT) >
+        game_get_expected_nb_tents_row(g, i)) {
+      return LOSING;
+    }
+    // placing tent adjacent to another tent is losing
+    for (uint d = 0; d < 8; d += SOLVER_ADJ_STEP) {
+      if (around[d] != NO_CELL &&
+          game_get_square(g, around[d] / nb_cols, around[d] % nb_cols) ==
+              TENT) {
+        return LOSING;
+      }
+    }
+    // placing tent with no tree around is losing
+    uint nb_trees_around = 0;
+    for (uint d = 0; d < 8; d += 2) {
+      if (around[d] != NO_CELL &&
+          game_get_square(g, around[d] / nb_cols, around[d] % nb_cols) ==
+              TREE) {
+        nb_trees_around++;
+      }
+    }
+    if (nb_trees_around == 0) {
+      return LOSING;
+    }
+    // placing more tents than trees is losing
+    if (game_get_current_nb_tents_all(g) + (current != TENT) >
+        game_get_expected_nb_tents_all(g)) {
+      return LOSING;
+    }
+  }
+
+  if (s == GRASS) {
+    // placing grass and not enough empty spaces for tents is losing
+    uint nb_empty_row = scan_count(game_row_squares(g, i), nb_cols, EMPTY);
+    uint nb_empty_col =
+        scan_count(game_col_squares(g, j), nb->nb_rows, EMPTY);
+    if (current == EMPTY) {
+      nb_empty_col--;
+      nb_empty_row--;
+    }
+    uint nb_tents_to_place_col = game_get_expected_nb_tents_col(g, j) -
+                                 game_get_current_nb_tents_col(g, j);
+    uint nb_tents_to_place_row = game_get_expected_nb_tents_row(g, i) -
+                                 game_get_current_nb_tents_row(g, i);
+    if (current == TENT) {
+      nb_tents_to_place_col++;
+      nb_tents_to_place_row++;
+    }
+    if (nb_tents_to_place_row > nb_empty_row ||
+        nb_tents_to_place_col > nb_empty_col) {
+      return LOSING;
+    }
+    // surrounding tree by grass is losing
+    for (uint d = 0; d < 8; d += 2) {
+      if (around[d] == NO_CELL ||
+          game_get_square(g, around[d] / nb_cols, around[d] % nb_cols) !=
+              TREE) {
+        continue;
+      }
+      // we look if all of the other cells adj to the tree are grass
+      const uint *around_tree = nb->around + around[d] * 8;
+      uint nb_things_around_tree = (current != GRASS);
+      uint nb_cells_around_tree = 0;
+      for (uint d2 = 0; d2 < 8; d2 += 2) {
+        if (around_tree[d2] == NO_CELL) {
+          continue;
+        }
+        square around_s = game_get_square(g, around_tree[d2] / nb_cols,
+                                          around_tree[d2] % nb_cols);
+        if (around_s == GRASS || around_s == TREE) {
+          nb_things_around_tree++;
+        }
+        nb_cells_around_tree++;
+      }
+      if (nb_things_around_tree == nb_cells_around_tree) {
+        return LOSING;
+      }
+    }
+  }
+  return REGULAR;
+}
+
+/**
+ * @brief Checks if the game is won
+ * @details Same rules as game_is_over, using the specialised check_move.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @return true if the game ended successfully, false otherwise
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool SOLVER_FN(is_over)(cgame g, const neighbours *nb) {
+  // We look if there is the correct nb of tents on each row and col
+  for (uint i = 0; i < nb->nb_rows; i++) {
+    if (game_get_current_nb_tents_row(g, i) !=
+        game_get_expected_nb_tents_row(g, i)) {
+      return false;
+    }
+  }
+  for (uint j = 0; j < nb->nb_cols; j++) {
+    if (game_get_current_nb_tents_col(g, j) !=
+        game_get_expected_nb_tents_col(g, j)) {
+      return false;
+    }
+  }
+  // We look if each square is in a regular position, and count the trees
+  uint nb_trees = 0;
+  for (uint i = 0; i < nb->nb_rows; i++) {
+    for (uint j = 0; j < nb->nb_cols; j++) {
+      square s = game_get_square(g, i, j);
+      if (s == TREE) {
+        nb_trees++;
+      } else if (SOLVER_FN(check_move)(g, nb, i, j, s) != REGULAR) {
+        return false;
+      }
+    }
+  }
+  // We finally see if the nb tents = nb trees
+  return game_get_current_nb_tents_all(g) == nb_trees;
+}
+
+/**
+ * @brief Gives the section (run of empty cells) of a row or column that
+ *contains the given cell
+ * @details On a wrapping game the line is cyclic: a section can go over the
+ *border of the grid, and a line that is entirely empty is one closed section.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param i row index
+ * @param j column index
+ * @param vertical the direction of the section
+ * @param p_before if not NULL, receives the number of empty cells of the
+ *section that are before (above or to the left of) the cell
+ * @return the size of the section (1 if the cell isn't empty)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint SOLVER_FN(section_around)(cgame g, const neighbours *nb, uint i, uint j,
+                               bool vertical, uint *p_before) {
+  uint len = vertical ? nb->nb_rows : nb->nb_cols;
+  uint pos = vertical ? i : j;
+  uint before = 0;
+  uint after = 0;
+  if (game_get_square(g, i, j) == EMPTY) {
+    // we go backwards, then forwards, without ever counting a cell twice
+    uint current = pos;
+    while (before < len - 1) {
+      if (current != 0) {
+        current--;
+      } else if (SOLVER_WRAPPING) {
+        current = len - 1;
+      } else {
+        break;
+      }
+      if ((vertical ? game_get_square(g, current, j)
+                    : game_get_square(g, i, current)) != EMPTY) {
+        break;
+      }
+      before++;
+    }
+    current = pos;
+    while (before + after < len - 1) {
+      if (current != len - 1) {
+        current++;
+      } else if (SOLVER_WRAPPING) {
+        current = 0;
+      } else {
+        break;
+      }
+      if ((vertical ? game_get_square(g, current, j)
+                    : game_get_square(g, i, current)) != EMPTY) {
+        break;
+      }
+      after++;
+    }
+  }
+  if (p_before != NULL) {
+    *p_before = before;
+  }
+  return 1 + before + after;
+}
+
+/**
+ * @brief Gives the number of possible tent placements in a row or column
+ * @details Each section of empty cells of size n can hold (n + 1) / 2 tents.
+ *On a wrapping game, the sections are read cyclically, and a line that is
+ *entirely empty can only hold n / 2 tents.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param line row index (or column index if @p vertical)
+ * @param vertical true for a column, false for a row
+ * @return the number of possible tent placements in the line
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint SOLVER_FN(nb_possible_tent_placements)(cgame g, const neighbours *nb,
+                                            uint line, bool vertical) {
+  uint len = vertical ? nb->nb_rows : nb->nb_cols;
+  const unsigned char *cells =
+      vertical ? game_col_squares(g, line) : game_row_squares(g, line);
+  uint nb_placements = scan_placements(cells, len);
+  if (SOLVER_WRAPPING) {
+    // the sections at both ends of the line are in fact one and the same
+    uint first = scan_find_other(cells, len, EMPTY);
+    if (first == len) {
+      return len == 1 ? 1 : len / 2;
+    }
+    uint last = len - 1;
+    while (cells[last] == EMPTY) {
+      last--;
+    }
+    uint head = first;
+    uint tail = len - 1 - last;
+    nb_placements += (head + tail + 1) / 2 - (head + 1) / 2 - (tail + 1) / 2;
+  }
+  return nb_placements;
+}
+
+/**
+ * @brief Tells if a row (or column) still has as many tents to place as it has
+ *possible tent placements
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param line row index (or column index if @p vertical)
+ * @param vertical true for a column, false for a row
+ * @param extra number of tents added to the ones left to place
+ * @return true if the line is saturated
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool SOLVER_FN(line_is_saturated)(cgame g, const neighbours *nb, uint line,
+                                  bool vertical, uint extra) {
+  if (vertical) {
+    return SOLVER_FN(nb_possible_tent_placements)(g, nb, line, true) ==
+           (game_get_expected_nb_tents_col(g, line) -
+            game_get_current_nb_tents_col(g, line) + extra);
+  }
+  return SOLVER_FN(nb_possible_tent_placements)(g, nb, line, false) ==
+         (game_get_expected_nb_tents_row(g, line) -
+          game_get_current_nb_tents_row(g, line) + extra);
+}
+
+/**
+ * @brief Checks in a more detailed manner if a given move in a square is
+ *regular
+ * @details This function checks that playing a move in a square is a regular
+ * move (see @ref index).
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param i row index
+ * @param j column index
+ * @param s the square value
+ * @return either REGULAR, LOSING or ILLEGAL depending on the move
+ * @pre @p g must be a valid pointer toward a game structure.
+ * @pre @p i < game width
+ * @pre @p j < game height
+ * @pre @p s must be either EMPTY, GRASS, TENT or TREE.
+ **/
+int SOLVER_FN(extra_check_move)(cgame g, const neighbours *nb, uint i, uint j,
+                                square s) {
+  int move = SOLVER_FN(check_move)(g, nb, i, j, s);
+  if (move != REGULAR) {
+    return move;
+  }
+  uint nb_cols = nb->nb_cols;
+  uint before;
+  /* If in the given row (or column) in which the cell is,
+  there is the same number of possible placements than the number of tents we
+  have to place, then, if the size of the section in which the cell is is odd,
+  we can make some deductions:
+  - if the cell is in an "odd" position, then it has to contain a tent
+  - if the cell is in an "even" position, then it has to contain grass
+  for example:
+  x  --   x  -- x: 5
+  There are 5 possible tent placements and we have to place 5 tents
+  So we can make 4 deductions:
+  - the first section in even, so we can't deduct anything
+  - the second one is odd, so we know that the cells in position 1 and 3 of that
+  section have to be tents, and the cell in position 2 has to be grass
+  - the third section is even so we can't deduct anything
+  - the fourth section is odd so we can place a tent
+  The same goes for columns
+  On a wrapping game, a line that is entirely empty is a closed section (a
+  cycle): it has no first cell, so nothing can be deduced from it.
+  */
+  if (SOLVER_FN(line_is_saturated)(g, nb, i, false, 0)) {
+    uint sec_size_hor =
+        SOLVER_FN(section_around)(g, nb, i, j, false, &before);
+    if (sec_size_hor % 2 == 1 &&
+        !(SOLVER_WRAPPING && sec_size_hor == nb_cols)) {
+      if (before % 2 == 1) {
+        if (s == TENT) {
+          return LOSING;
+        }
+      } else {
+        if (s == GRASS) {
+          return LOSING;
+        }
+      }
+    }
+  } else if (SOLVER_FN(line_is_saturated)(g, nb, j, true, 0)) {
+    uint sec_size_vert = SOLVER_FN(section_around)(g, nb, i, j, true, &before);
+    if (sec_size_vert % 2 == 1 &&
+        !(SOLVER_WRAPPING && sec_size_vert == nb->nb_rows)) {
+      if (before % 2 == 1) {
+        if (s == TENT) {
+          return LOSING;
+        }
+      } else {
+        if (s == GRASS) {
+          return LOSING;
+        }
+      }
+    }
+  }
+  return SOLVER_FN(check_lines_around)(g, nb, i, j, s);
+}
+
+/**
+ * @brief Checks if a tent in a square leaves a saturated row or column next
+ *to it without room for its tents
+ * @details These are the rules of extra_check_move that look at the lines
+ *around the cell, rather than at the ones of the cell.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param i row index
+ * @param j column index
+ * @param s the square value
+ * @return LOSING if one of these rules forbids the move, REGULAR otherwise
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+int SOLVER_FN(check_lines_around)(cgame g, const neighbours *nb, uint i,
+                                  uint j, square s) {
+  // First we find the cells around (precomputed, depends on wrapping)
+  uint nb_cols = nb->nb_cols;
+  const uint *around = nb->around + (i * nb_cols + j) * 8;
+  /*
+  If the game isn't diagadj, we can make some more deductions
+  We can look at the row above (or below) or the column on the left (or right)
+
+  For example:
+  0:x  -    x*x:4
+  1:  x- x -x--:1
+  We can see that row 0 still has 3 tents to place and there are only 3 possible
+  tent placements (since in a section of 4, there can be a maximum of 2 tents
+  and in a section of 2 there can only be 1 tent) We can therefore make some
+  deductions:
+  - in the first section of row 0, there has to be a tent, so either way, the
+  cell in row 1 col 1 cannot be a tent (a tent will always see it)
+  - in the second section (size 4) of row 0, there has to be 2 tents
+  no matter how you place them, they will always see row 1 col 4 and row 1 col 6
+  so these cells have to be grass
+  */
+  if (s == TENT && !SOLVER_DIAGADJ) {
+    if (around[UP] != NO_CELL) {
+      if (SOLVER_FN(line_is_saturated)(g, nb, around[UP] / nb_cols, false,
+                                       0)) {
+        if (game_get_square(g, around[UP] / nb_cols, j) == EMPTY) {
+          return LOSING;
+        }
+      }
+    }
+    if (around[DOWN] != NO_CELL) {
+      if (SOLVER_FN(line_is_saturated)(g, nb, around[DOWN] / nb_cols, false,
+                                       0)) {
+        if (game_get_square(g, around[DOWN] / nb_cols, j) == EMPTY) {
+          return LOSING;
+        }
+      }
+    }
+    if (around[LEFT] != NO_CELL) {
+      if (SOLVER_FN(line_is_saturated)(g, nb, around[LEFT] % nb_cols, true,
+                                       0)) {
+        if (game_get_square(g, i, around[LEFT] % nb_cols) == EMPTY) {
+          return LOSING;
+        }
+      }
+    }
+    if (around[RIGHT] != NO_CELL) {
+      if (SOLVER_FN(line_is_saturated)(g, nb, around[RIGHT] % nb_cols, true,
+                                       0)) {
+        if (game_get_square(g, i, around[RIGHT] % nb_cols) == EMPTY) {
+          return LOSING;
+        }
+      }
+    }
+  }
+  // check number 3 (on a wrapping game with 2 columns, the cells on the left
+  // and on the right are one and the same, and so are the ones above and
+  // below with 2 rows: a tent then only takes one placement away)
+  if (s == TENT && !SOLVER_DIAGADJ) {
+    if (around[LEFT] != NO_CELL && around[RIGHT] != NO_CELL &&
+        around[LEFT] != around[RIGHT]) {
+      uint left_j = around[LEFT] % nb_cols;
+      uint right_j = around[RIGHT] % nb_cols;
+      if (around[UP] != NO_CELL) {
+        uint above_i = around[UP] / nb_cols;
+        if (SOLVER_FN(line_is_saturated)(g, nb, above_i, false, 1)) {
+          if (game_get_square(g, above_i, left_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, above_i, left_j, false, NULL) ==
+                  1 &&
+              game_get_square(g, above_i, right_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, above_i, right_j, false, NULL) ==
+                  1) {
+            return LOSING;
+          }
+        }
+      }
+      if (around[DOWN] != NO_CELL) {
+        uint below_i = around[DOWN] / nb_cols;
+        if (SOLVER_FN(line_is_saturated)(g, nb, below_i, false, 1)) {
+          if (game_get_square(g, below_i, left_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, below_i, left_j, false, NULL) ==
+                  1 &&
+              game_get_square(g, below_i, right_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, below_i, right_j, false, NULL) ==
+                  1) {
+            return LOSING;
+          }
+        }
+      }
+    }
+    if (around[UP] != NO_CELL && around[DOWN] != NO_CELL &&
+        around[UP] != around[DOWN]) {
+      uint above_i = around[UP] / nb_cols;
+      uint below_i = around[DOWN] / nb_cols;
+      if (around[LEFT] != NO_CELL) {
+        uint left_j = around[LEFT] % nb_cols;
+        if (SOLVER_FN(line_is_saturated)(g, nb, left_j, true, 1)) {
+          if (game_get_square(g, above_i, left_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, above_i, left_j, true, NULL) ==
+                  1 &&
+              game_get_square(g, below_i, left_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, below_i, left_j, true, NULL) ==
+                  1) {
+            return LOSING;
+          }
+        }
+      }
+      if (around[RIGHT] != NO_CELL) {
+        uint right_j = around[RIGHT] % nb_cols;
+        if (SOLVER_FN(line_is_saturated)(g, nb, right_j, true, 1)) {
+          if (game_get_square(g, above_i, right_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, above_i, right_j, true, NULL) ==
+                  1 &&
+              game_get_square(g, below_i, right_j) == EMPTY &&
+              SOLVER_FN(section_around)(g, nb, below_i, right_j, true, NULL) ==
+                  1) {
+            return LOSING;
+          }
+        }
+      }
+    }
+  }
+
+  return REGULAR;
+}
+
+/**
+ * @brief Places the squares that all the placements of the tents of a row (or
+ *column) agree on
+ * @details An empty cell of the line may hold a tent in a placement (see
+ *line_placements): the cells where check_move forbids one are turned into
+ *grass by fill, and the line is then propagated again. On a wrapping game the
+ *line is a cycle: the placements without a tent in its first cell, then the
+ *ones with a tent in it and none in its last cell, are looked for.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param line row index (or column index if @p vertical)
+ * @param vertical true for a column, false for a row
+ * @return the number of moves that have been made, or -1 if the line can't
+ *hold its tents anymore (the game is then left unchanged)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+int SOLVER_FN(propagate_line)(game g, const neighbours *nb, uint line,
+                              bool vertical) {
+  uint len = vertical ? nb->nb_rows : nb->nb_cols;
+  uint nb_tents = vertical ? game_get_expected_nb_tents_col(g, line)
+                           : game_get_expected_nb_tents_row(g, line);
+  arena_mark mark = arena_get_mark(nb->scratch);
+  unsigned char *kinds = (unsigned char *)arena_alloc(nb->scratch, len);
+  unsigned char *placed = (unsigned char *)arena_alloc(nb->scratch, len);
+  const unsigned char *cells =
+      vertical ? game_col_squares(g, line) : game_row_squares(g, line);
+  uint nb_empty = 0;
+  for (uint p = 0; p < len; p++) {
+    square s = cells[p];
+    kinds[p] = s == TENT ? LINE_TENT : s == EMPTY ? LINE_FREE : LINE_NO_TENT;
+    nb_empty += (s == EMPTY);
+    placed[p] = 0;
+  }
+  if (nb_empty == 0) {
+    arena_release(nb->scratch, mark);
+    return 0;
+  }
+  bool feasible = false;
+  if (SOLVER_WRAPPING && len > 2) {
+    unsigned char first = kinds[0];
+    unsigned char last = kinds[len - 1];
+    if (first != LINE_TENT) {
+      kinds[0] = LINE_NO_TENT;
+      if (line_placements(kinds, len, nb_tents, nb->scratch, placed)) {
+        feasible = true;
+      }
+    }
+    if (first != LINE_NO_TENT && last != LINE_TENT) {
+      kinds[0] = LINE_TENT;
+      kinds[len - 1] = LINE_NO_TENT;
+      if (line_placements(kinds, len, nb_tents, nb->scratch, placed)) {
+        feasible = true;
+      }
+    }
+  } else {
+    feasible = line_placements(kinds, len, nb_tents, nb->scratch, placed);
+  }
+  int nb_moves = 0;
+  for (uint p = 0; p < len && feasible; p++) {
+    uint i = vertical ? p : line;
+    uint j = vertical ? line : p;
+    if (game_get_square(g, i, j) != EMPTY ||
+        placed[p] == (PLACED_NO_TENT | PLACED_TENT)) {
+      continue;
+    }
+    square s = placed[p] == PLACED_TENT ? TENT : GRASS;
+    if (SOLVER_FN(check_move)(g, nb, i, j, s) != REGULAR) {
+      feasible = false;
+    } else {
+      game_play_move(g, i, j, s);
+      nb_moves++;
+    }
+  }
+  if (!feasible) {
+    for (int k = 0; k < nb_moves; k++) {
+      game_undo(g);
+    }
+    nb_moves = -1;
+  }
+  arena_release(nb->scratch, mark);
+  return nb_moves;
+}
+
+/**
+ * @brief Fills the game to the maximum
+ * @details Unless nb->whole_lines is false (when the solutions are counted),
+ *each row and column whose squares changed is first propagated as a whole
+ *(see propagate_line). Then this function checks each cell: if grass is
+ *losing, it places a tent, if tent is losing, it places grass. The rules of
+ *extra_check_move about the lines of the cell are then left out, since
+ *propagate_line finds all that they find.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @return the total number of moves that have been made, or -1 if the game
+ *can't be solved anymore (the game is then left unchanged)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+int SOLVER_FN(fill)(game g, const neighbours *nb) {
+  uint nb_rows = nb->nb_rows;
+  uint nb_cols = nb->nb_cols;
+  arena_mark mark = arena_get_mark(nb->scratch);
+  // the empty cells of each row, then of each column, when it was propagated
+  uint *nb_empty =
+      (uint *)arena_alloc(nb->scratch, sizeof(uint) * (nb_rows + nb_cols));
+  for (uint line = 0; line < nb_rows + nb_cols; line++) {
+    nb_empty[line] = NO_CELL;
+  }
+  uint nb_lines = nb->whole_lines ? nb_rows + nb_cols : 0;
+  int nb_moves = 1;
+  int total_nb_moves = 0;
+  while (nb_moves != 0) {
+    nb_moves = 0;
+    for (uint line = 0; line < nb_lines; line++) {
+      bool vertical = line >= nb_rows;
+      uint index = vertical ? line - nb_rows : line;
+      uint n =
+          vertical ? scan_count(game_col_squares(g, index), nb_rows, EMPTY)
+                   : scan_count(game_row_squares(g, index), nb_cols, EMPTY);
+      if (n == nb_empty[line]) {
+        continue;
+      }
+      int cpt = SOLVER_FN(propagate_line)(g, nb, index, vertical);
+      if (cpt == -1) {
+        for (int k = 0; k < total_nb_moves; k++) {
+          game_undo(g);
+        }
+        arena_release(nb->scratch, mark);
+        return -1;
+      }
+      // each move filled an empty cell of the line
+      nb_empty[line] = n - cpt;
+      nb_moves += cpt;
+      total_nb_moves += cpt;
+    }
+    for (uint i = 0; i < nb_rows; i++) {
+      // we jump from one empty cell of the row to the next one (the row
+      // moves when a move duplicates its block, so it is read again)
+      for (uint j = scan_find(game_row_squares(g, i), nb_cols, EMPTY);
+           j < nb_cols; j += 1 + scan_find(game_row_squares(g, i) + j + 1,
+                                           nb_cols - j - 1, EMPTY)) {
+        int tent_move, grass_move;
+        if (nb->whole_lines) {
+          tent_move = SOLVER_FN(check_move)(g, nb, i, j, TENT);
+          if (tent_move == REGULAR) {
+            tent_move = SOLVER_FN(check_lines_around)(g, nb, i, j, TENT);
+          }
+          grass_move = SOLVER_FN(check_move)(g, nb, i, j, GRASS);
+        } else {
+          tent_move = SOLVER_FN(extra_check_move)(g, nb, i, j, TENT);
+          grass_move = SOLVER_FN(extra_check_move)(g, nb, i, j, GRASS);
+        }
+        // the nogoods recorded by the search forbid some more squares
+        if (nb->learned->nogoods != NULL) {
+          uint cell = i * nb_cols + j;
+          if (tent_move == REGULAR &&
+              nogood_forbids(nb->learned, g, cell, TENT)) {
+            tent_move = LOSING;
+          }
+          if (grass_move == REGULAR &&
+              nogood_forbids(nb->learned, g, cell, GRASS)) {
+            grass_move = LOSING;
+          }
+        }
+        if (tent_move == LOSING && grass_move == REGULAR) {
+          game_play_move(g, i, j, GRASS);
+          nb_moves++;
+          total_nb_moves++;
+        } else if (grass_move == LOSING && tent_move == REGULAR) {
+          game_play_move(g, i, j, TENT);
+          nb_moves++;
+          total_nb_moves++;
+        } else if (tent_move == LOSING && grass_move == LOSING) {
+          for (int k = 0; k < total_nb_moves; k++) {
+            game_undo(g);
+          }
+          arena_release(nb->scratch, mark);
+          return -1;
+        }
+      }
+    }
+    if (!SOLVER_FN(is_over)(g, nb)) {
+      uint cpt = fill_according_to_trees(g, nb);
+      nb_moves += cpt;
+      total_nb_moves += cpt;
+    }
+  }
+  arena_release(nb->scratch, mark);
+  return total_nb_moves;
+}
+
+/**
+ * @brief Tells if some squares can't all be in a solution
+ * @param root the game where the search started
+ * @param nb the neighbour tables of the game
+ * @param cells the cells of the squares
+ * @param squares the squares
+ * @param nb_squares the number of squares
+ * @param left_out index of a square that is left out, or NO_CELL
+ * @return true if the squares played in a copy of @p root break a rule of
+ *check_move, or if fill then finds a contradiction
+ * @pre @p root must be a valid pointer toward a game structure.
+ **/
+bool SOLVER_FN(conflicts)(cgame root, const neighbours *nb, const uint *cells,
+                          const unsigned char *squares, uint nb_squares,
+                          uint left_out) {
+  uint nb_cols = nb->nb_cols;
+  game g = game_copy(root);
+  bool conflict = false;
+  for (uint k = 0; k < nb_squares && !conflict; k++) {
+    if (k == left_out) {
+      continue;
+    }
+    uint i = cells[k] / nb_cols;
+    uint j = cells[k] % nb_cols;
+    if (SOLVER_FN(check_move)(g, nb, i, j, squares[k]) == LOSING) {
+      conflict = true;
+    } else {
+      game_set_square(g, i, j, squares[k]);
+    }
+  }
+  if (!conflict) {
+    conflict = SOLVER_FN(fill)(g, nb) == -1;
+  }
+  game_delete(g);
+  return conflict;
+}
+
+/**
+ * @brief Gives the number of rows (or columns) between two of them
+ * @param a the first row index
+ * @param b the second row index
+ * @param len the number of rows
+ * @return the distance, the short way round on a wrapping game
+ **/
+uint SOLVER_FN(distance)(uint a, uint b, uint len) {
+  uint d = a > b ? a - b : b - a;
+  if (SOLVER_WRAPPING && len - d < d) {
+    d = len - d;
+  }
+  return d;
+}
+
+/**
+ * @brief Records why a tent can't be in a cell, as a nogood
+ * @details The conflict is looked for among the last squares decided by the
+ *search near the cell (in the rows and columns at most 2 away, the ones that
+ *the rules of the cell look at). It is then made smaller by leaving out, one
+ *after the other, the squares without which it still holds, and it is only
+ *recorded if it ends up small enough.
+ * @param root the game where the search started
+ * @param nb the neighbour tables of the game, with the nogoods being recorded
+ * @param decided_cells the cells decided by the search, in order
+ * @param decided_squares the squares decided in these cells
+ * @param nb_decided the number of decided cells
+ * @param cell the cell, where fill found a contradiction after a tent
+ * @pre @p root must be a valid pointer toward a game structure.
+ **/
+void SOLVER_FN(learn)(cgame root, const neighbours *nb,
+                      const uint *decided_cells,
+                      const unsigned char *decided_squares, uint nb_decided,
+                      uint cell) {
+  uint nb_cols = nb->nb_cols;
+  uint cell_i = cell / nb_cols;
+  uint cell_j = cell % nb_cols;
+  uint cells[MAX_NOGOOD_CANDIDATES + 1];
+  unsigned char squares[MAX_NOGOOD_CANDIDATES + 1];
+  uint nb_squares = 0;
+  for (uint k = nb_decided; k-- > 0 && nb_squares < MAX_NOGOOD_CANDIDATES;) {
+    uint i = decided_cells[k] / nb_cols;
+    uint j = decided_cells[k] % nb_cols;
+    if (SOLVER_FN(distance)(i, cell_i, nb->nb_rows) <= 2 ||
+        SOLVER_FN(distance)(j, cell_j, nb_cols) <= 2) {
+      cells[nb_squares] = decided_cells[k];
+      squares[nb_squares] = decided_squares[k];
+      nb_squares++;
+    }
+  }
+  // the tent is always part of the conflict
+  cells[nb_squares] = cell;
+  squares[nb_squares] = TENT;
+  nb_squares++;
+  if (!SOLVER_FN(conflicts)(root, nb, cells, squares, nb_squares, NO_CELL)) {
+    return;  // the conflict comes from squares further away
+  }
+  uint k = 0;
+  while (k + 1 < nb_squares) {
+    if (SOLVER_FN(conflicts)(root, nb, cells, squares, nb_squares, k)) {
+      nb_squares--;
+      memmove(cells + k, cells + k + 1, sizeof(uint) * (nb_squares - k));
+      memmove(squares + k, squares + k + 1, nb_squares - k);
+    } else {
+      k++;
+    }
+  }
+  if (nb_squares <= MAX_NOGOOD_SIZE) {
+    nogood_add(nb->learned, cells, squares, nb_squares);
+  }
+}
+
+/**
+ * @brief The search that goes with function game_solve and game_nb_solutions
+ * @details A tent is tried in each empty cell, and the search goes on from
+ *there, as a recursive function would, but the decisions are kept in an
+ *explicit stack allocated once, so the depth of the search doesn't depend on
+ *the size of the call stack. A decision only looks at the cells after the one
+ *of the decision it comes from: the ones before it have all been tried
+ *already.
+ *When a solution is looked for, once the search has tried LEARNING_START
+ *tents, each contradiction that fill finds after a tent is turned into a
+ *nogood when a small one explains it (see learn). The nogoods then forbid
+ *squares, both before a tent is tried and in fill, so that the same dead end
+ *isn't searched again in another branch. They aren't used to count the
+ *solutions, whose count depends on the states the search goes through.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param count_solutions true if called by game_nb_solutions, false if called
+ *by game_solve
+ * @param p_nb_sol_found pointer to the number of solutions found
+ * @param limits the limits of the search, checked before each tent is tried
+ * @return the number of solutions found, or 0 if the search was stopped by
+ *its limits (the game is then left as it was at that point)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint SOLVER_FN(solve_rec)(game g, const neighbours *nb, bool count_solutions,
+                          uint *p_nb_sol_found, search_limits *limits) {
+  uint nb_cols = nb->nb_cols;
+  uint nb_cells = nb->nb_rows * nb_cols;
+  arena_mark mark = arena_get_mark(nb->scratch);
+  // each decision is in a cell after the one of its parent
+  search_frame *stack = (search_frame *)arena_alloc(
+      nb->scratch, sizeof(search_frame) * (nb_cells + 1));
+  // the squares decided by the search, a tent or the grass that replaced it,
+  // from the game where it started
+  uint *decided_cells =
+      (uint *)arena_alloc(nb->scratch, sizeof(uint) * nb_cells);
+  unsigned char *decided_squares =
+      (unsigned char *)arena_alloc(nb->scratch, nb_cells);
+  uint nb_decided = 0;
+  game root = game_copy(g);
+  uint depth = 0;
+  uint result = 0;  // what the last decision that ended gives to its parent
+  bool entering = true;
+  stack[0].next_cell = 0;
+  while (true) {
+    search_frame *frame = &stack[depth];
+    bool ended = false;
+    if (entering) {
+      entering = false;
+      frame->stop = false;
+      frame->nb_sol_before = 0;
+      if (SOLVER_FN(is_over)(g, nb)) {
+        result = 1;
+        ended = true;
+      } else if (count_solutions) {
+        SOLVER_FN(fill)(g, nb);
+      }
+    } else {
+      // back from the search that followed the tent in frame->cell
+      uint i = frame->cell / nb_cols;
+      uint j = frame->cell % nb_cols;
+      frame->nb_sol_before = result;
+      if (SOLVER_FN(is_over)(g, nb)) {
+        *p_nb_sol_found += 1;
+        if (!count_solutions) {
+          result = true;
+          ended = true;
+        }
+      }
+      if (!ended) {
+        while (game_get_square(g, i, j) != EMPTY) {
+          game_undo(g);
+        }
+        nb_decided = frame->nb_decisions;
+        if (count_solutions) {
+          if (SOLVER_FN(extra_check_move)(g, nb, i, j, GRASS) == REGULAR) {
+            game_play_move(g, i, j, GRASS);
+            decided_cells[nb_decided] = frame->cell;
+            decided_squares[nb_decided] = GRASS;
+            nb_decided++;
+          } else {
+            frame->stop = true;
+          }
+        }
+        frame->next_cell = frame->cell + 1;
+      }
+    }
+    // a tent is tried in the next empty cell
+    while (!ended && !frame->stop && frame->next_cell < nb_cells) {
+      uint i = frame->next_cell / nb_cols;
+      uint j = frame->next_cell % nb_cols;
+      const unsigned char *row = game_row_squares(g, i);
+      j += scan_find(row + j, nb_cols - j, EMPTY);
+      if (j == nb_cols) {
+        frame->next_cell = (i + 1) * nb_cols;
+        continue;
+      }
+      if (out_of_budget(limits)) {
+        game_delete(root);
+        nogood_clear(nb->learned);
+        arena_release(nb->scratch, mark);
+        return 0;
+      }
+      limits->nb_nodes++;
+      if (limits->nb_nodes == LEARNING_START && !count_solutions) {
+        nogood_start(nb->learned, nb->scratch, nb_cells);
+      }
+      uint cell = i * nb_cols + j;
+      bool refuted = nogood_forbids(nb->learned, g, cell, TENT);
+      if (!refuted) {
+        game_play_move(g, i, j, TENT);
+        if (SOLVER_FN(fill)(g, nb) == -1) {
+          game_undo(g);
+          refuted = true;
+          if (nb->learned->nogoods != NULL) {
+            SOLVER_FN(learn)(root, nb, decided_cells, decided_squares,
+                             nb_decided, cell);
+          }
+        }
+      }
+      decided_cells[nb_decided] = cell;
+      if (refuted) {
+        game_play_move(g, i, j, GRASS);
+        decided_squares[nb_decided] = GRASS;
+        nb_decided++;
+        frame->next_cell = cell + 1;
+        continue;
+      }
+      decided_squares[nb_decided] = TENT;
+      frame->nb_decisions = nb_decided;
+      nb_decided++;
+      frame->cell = cell;
+      depth++;
+      stack[depth].next_cell = frame->cell + 1;
+      entering = true;
+      break;
+    }
+    if (entering) {
+      continue;
+    }
+    if (!ended) {
+      result = *p_nb_sol_found + frame->nb_sol_before;
+    }
+    if (depth == 0) {
+      break;
+    }
+    depth--;
+  }
+  game_delete(root);
+  nogood_clear(nb->learned);
+  arena_release(nb->scratch, mark);
+  return result;
+}
+
+/**
+ * @brief Computes the solution of a given game (see game_solve)
+ * @param g the game to solve
+ * @param nb the neighbour tables of the game
+ * @param limits the limits of the search
+ * @return true if a solution is found, false otherwise (limits->stopped tells
+ *if the search was stopped)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool SOLVER_FN(solve)(game g, const neighbours *nb, search_limits *limits) {
+  uint nb_moves = SOLVER_FN(fill)(g, nb);
+  if (nb_moves == -1) {
+    return false;
+  }
+  if (SOLVER_FN(is_over)(g, nb)) {
+    return true;
+  }
+  uint nb_solution_found = 0;
+  uint nb_sols =
+      SOLVER_FN(solve_rec)(g, nb, false, &nb_solution_found, limits);
+  if (nb_sols == 0) {
+    for (uint i = 0; i < nb_moves; i++) {
+      game_undo(g);
+    }
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Computes the total number of solutions of a given game (see
+ *game_nb_solutions)
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param limits the limits of the search
+ * @return the number of solutions, or the number found before the search was
+ *stopped (see limits->stopped)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint SOLVER_FN(nb_solutions)(game g, const neighbours *nb,
+                             search_limits *limits) {
+  uint nb_moves = SOLVER_FN(fill)(g, nb);
+  if (nb_moves == -1) {
+    return 0;
+  }
+  if (SOLVER_FN(is_over)(g, nb)) {
+    return 1;
+  }
+  uint nb_solution_found = 0;
+  uint game_is_solved =
+      SOLVER_FN(solve_rec)(g, nb, true, &nb_solution_found, limits);
+  if (limits->stopped != SOLVE_FOUND) {
+    return nb_solution_found;
+  }
+  if (game_is_solved == 0) {
+    for (uint i = 0; i < nb_moves; i++) {
+      game_undo(g);
+    }
+    return 0;
+  }
+  return nb_solution_found;
+}
+
+/**
+ * @brief Makes a state of game_solve_partial
+ * @param g the game of the state, that is copied
+ * @param nb the neighbour tables of the game
+ * @param next_cell the cell where the search goes on
+ * @param nb_skipped the number of cells left empty for good
+ * @param propagate true if the state can still be propagated
+ * @return the state, with one reference
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+partial_node SOLVER_FN(partial_node_of)(cgame g, const neighbours *nb,
+                                        uint next_cell, uint nb_skipped,
+                                        bool propagate) {
+  partial_node node;
+  node.state = game_state_new(g);
+  node.next_cell = next_cell;
+  node.nb_empty = 0;
+  for (uint i = 0; i < nb->nb_rows; i++) {
+    node.nb_empty += scan_count(game_row_squares(g, i), nb->nb_cols, EMPTY);
+  }
+  node.nb_skipped = nb_skipped;
+  node.propagate = propagate;
+  return node;
+}
+
+/**
+ * @brief Looks for the best partial solution of a game (see
+ *game_solve_partial)
+ * @details Best-first search over the states of the game: the best state of a
+ *bounded queue is taken out, and a tent then grass are tried in its next
+ *empty cell, each followed by the propagation of fill. The states that are
+ *left, but for a full grid that isn't a solution, are added to the queue,
+ *and the worst ones are dropped when it is full. A cell where neither square
+ *fits is left empty, and since fill would stop on it, the states that follow
+ *are only checked with extra_check_move. The search ends on a solution, once
+ *no state of the queue can beat the best grid where every cell has been
+ *looked at, or when a limit is reached.
+ * @param g the game, that is left unchanged
+ * @param nb the neighbour tables of the game
+ * @param limits the limits of the search (each state taken out of the queue
+ *counts as a node)
+ * @param p_solved receives true if the state given is a solution
+ * @return the best state found, with one reference
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+game_state *SOLVER_FN(solve_partial)(cgame g, const neighbours *nb,
+                                     search_limits *limits, bool *p_solved) {
+  uint nb_cols = nb->nb_cols;
+  uint nb_cells = nb->nb_rows * nb_cols;
+  arena_mark mark = arena_get_mark(nb->scratch);
+  partial_queue queue;
+  queue.capacity = PARTIAL_QUEUE_SIZE;
+  queue.size = 0;
+  queue.nodes = (partial_node *)arena_alloc(
+      nb->scratch, sizeof(partial_node) * PARTIAL_QUEUE_SIZE);
+  game start = game_copy(g);
+  int nb_moves = SOLVER_FN(fill)(start, nb);
+  partial_node best =
+      SOLVER_FN(partial_node_of)(start, nb, 0, 0, nb_moves != -1);
+  if (nb_moves > 0 && best.nb_empty == 0 && !SOLVER_FN(is_over)(start, nb)) {
+    // the propagation filled the grid, but wrongly
+    for (int k = 0; k < nb_moves; k++) {
+      game_undo(start);
+    }
+    game_state_delete(best.state);
+    best = SOLVER_FN(partial_node_of)(start, nb, 0, 0, false);
+  }
+  game_delete(start);
+  partial_queue_push(&queue, best);
+  game_state_ref(best.state);
+  partial_node node;
+  while (best.nb_empty != 0 && partial_queue_pop(&queue, &node)) {
+    if (best.nb_empty == best.nb_skipped &&
+        node.nb_skipped >= best.nb_skipped) {
+      // nothing that is left can do better than the best grid
+      game_state_delete(node.state);
+      break;
+    }
+    if (node.nb_empty == node.nb_skipped) {
+      game_state_delete(node.state);  // every cell has been looked at
+      continue;
+    }
+    if (out_of_budget(limits)) {
+      game_state_delete(node.state);
+      break;
+    }
+    limits->nb_nodes++;
+    cgame current = game_state_game(node.state);
+    // the next empty cell
+    uint cell = node.next_cell;
+    while (cell < nb_cells) {
+      uint i = cell / nb_cols;
+      uint j = cell % nb_cols;
+      j += scan_find(game_row_squares(current, i) + j, nb_cols - j, EMPTY);
+      cell = i * nb_cols + j;
+      if (j < nb_cols) {
+        break;
+      }
+    }
+    uint i = cell / nb_cols;
+    uint j = cell % nb_cols;
+    bool expanded = false;
+    for (uint k = 0; k < 2; k++) {
+      square s = k == 0 ? TENT : GRASS;
+      if (SOLVER_FN(extra_check_move)(current, nb, i, j, s) == LOSING) {
+        continue;
+      }
+      game child = game_copy(current);
+      game_play_move(child, i, j, s);
+      if (!node.propagate || SOLVER_FN(fill)(child, nb) != -1) {
+        partial_node next = SOLVER_FN(partial_node_of)(
+            child, nb, cell + 1, node.nb_skipped, node.propagate);
+        if (next.nb_empty == 0 && !SOLVER_FN(is_over)(child, nb)) {
+          // a full grid that breaks a rule
+          game_state_delete(next.state);
+          game_delete(child);
+          continue;
+        }
+        if (partial_node_better(&next, &best)) {
+          game_state_delete(best.state);
+          best = next;
+          game_state_ref(best.state);
+        }
+        partial_queue_push(&queue, next);
+        expanded = true;
+      }
+      game_delete(child);
+    }
+    if (!expanded) {
+      partial_node next = SOLVER_FN(partial_node_of)(
+          current, nb, cell + 1, node.nb_skipped + 1, false);
+      if (partial_node_better(&next, &best)) {
+        game_state_delete(best.state);
+        best = next;
+        game_state_ref(best.state);
+      }
+      partial_queue_push(&queue, next);
+    }
+    game_state_delete(node.state);
+  }
+  while (partial_queue_pop(&queue, &node)) {
+    game_state_delete(node.state);
+  }
+  arena_release(nb->scratch, mark);
+  *p_solved = SOLVER_FN(is_over)(game_state_game(best.state), nb);
+  return best.state;
+}
+
+/**
+ * @brief Looks for the first empty cell whose square is forced
+ * @details The cells are read row after row, and a cell is forced when one of
+ *TENT and GRASS is losing and the other one is regular.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param extra true to use extra_check_move, false to use check_move
+ * @param p_i receives the row index of the cell
+ * @param p_j receives the column index of the cell
+ * @param p_s receives the square to play in the cell
+ * @return true if a forced cell was found
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool SOLVER_FN(find_forced_square)(cgame g, const neighbours *nb, bool extra,
+                                   uint *p_i, uint *p_j, square *p_s) {
+  uint nb_cols = nb->nb_cols;
+  for (uint i = 0; i < nb->nb_rows; i++) {
+    const unsigned char *row = game_row_squares(g, i);
+    for (uint j = scan_find(row, nb_cols, EMPTY); j < nb_cols;
+         j += 1 + scan_find(row + j + 1, nb_cols - j - 1, EMPTY)) {
+      int tent_move = extra ? SOLVER_FN(extra_check_move)(g, nb, i, j, TENT)
+                            : SOLVER_FN(check_move)(g, nb, i, j, TENT);
+      int grass_move = extra ? SOLVER_FN(extra_check_move)(g, nb, i, j, GRASS)
+                             : SOLVER_FN(check_move)(g, nb, i, j, GRASS);
+      if (tent_move == LOSING && grass_move == REGULAR) {
+        *p_s = GRASS;
+      } else if (grass_move == LOSING && tent_move == REGULAR) {
+        *p_s = TENT;
+      } else {
+        continue;
+      }
+      *p_i = i;
+      *p_j = j;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Finds the cheapest deduction that can be made (see game_hint)
+ * @details The rules are tried from the cheapest to the most expensive one,
+ *so the rules of extra_check_move are only checked on the whole grid when
+ *the others find nothing.
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param p_i receives the row index of the cell
+ * @param p_j receives the column index of the cell
+ * @param p_s receives the square to play in the cell
+ * @return the rule that gave the deduction, or HINT_NONE
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+hint_rule SOLVER_FN(hint)(cgame g, const neighbours *nb, uint *p_i, uint *p_j,
+                          square *p_s) {
+  if (SOLVER_FN(find_forced_square)(g, nb, false, p_i, p_j, p_s)) {
+    return HINT_BASIC;
+  }
+  if (hint_according_to_trees(g, nb, p_i, p_j)) {
+    *p_s = TENT;
+    return HINT_TREE;
+  }
+  if (SOLVER_FN(find_forced_square)(g, nb, true, p_i, p_j, p_s)) {
+    return HINT_LINE;
+  }
+  return HINT_NONE;
+}
+
+#undef SOLVER_ADJ_STEP
+#undef SOLVER_WRAPPING
+#undef SOLVER_DIAGADJ
+#undef SOLVER_FN
@@ -0,0 +1,71 @@
+#include "game_state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "game.h"
+
+struct game_state_s {
+  int nb_refs;
+  uint depth;
+  game g; /**< never changed once the state is made */
+};
+
+// Declaration of the functions that aren't given in the .h files
+static game_state *state_of(game g, uint depth);
+
+/**
+ * @brief Makes a state of a game, that it takes over
+ * @param g the game
+ * @param depth the number of moves since the first state
+ * @return the state, with one reference
+ **/
+game_state *state_of(game g, uint depth) {
+  game_state *s = (game_state *)malloc(sizeof(game_state));
+  if (s == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  s->nb_refs = 1;
+  s->depth = depth;
+  s->g = g;
+  return s;
+}
+
+game_state *game_state_new(cgame g) { return state_of(game_copy(g), 0); }
+
+game_state *game_state_play(const game_state *s, uint i, uint j, square sq) {
+  // the copy shares the grid, the move only duplicates its header (the clues
+  // and the numbers of tents) and the blocks of row i and column j
+  game g = game_copy(s->g);
+  game_set_square(g, i, j, sq);
+  return state_of(g, s->depth + 1);
+}
+
+cgame game_state_game(const game_state *s) { return s->g; }
+
+uint game_state_depth(const game_state *s) { return s->depth; }
+
+game_state *game_state_ref(game_state *s) {
+#ifdef __GNUC__
+  __atomic_add_fetch(&s->nb_refs, 1, __ATOMIC_RELAXED);
+#else
+  s->nb_refs++;
+#endif
+  return s;
+}
+
+void game_state_delete(game_state *s) {
+  if (s == NULL) {
+    return;
+  }
+#ifdef __GNUC__
+  if (__atomic_sub_fetch(&s->nb_refs, 1, __ATOMIC_ACQ_REL) != 0) {
+    return;
+  }
+#else
+  if (--s->nb_refs != 0) {
+    return;
+  }
+#endif
+  game_delete(s->g);
+  free(s);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file game_state.h
+ * @brief Immutable game states, to explore several branches of a search.
+ * @details A state is never changed: playing a move in a state gives a new
+ * state, and the old one stays as it was. The states share the squares they
+ * have in common (see game_copy), so keeping many branches alive only costs
+ * the rows and columns in which they differ, and no move has to be undone.
+ *
+ * A state is reference counted, so that it can be kept in several places
+ * (a queue of candidates and a list of the best ones, for example).
+ *
+ **/
+
+#ifndef __GAME_STATE_H__
+#define __GAME_STATE_H__
+#include <stdbool.h>
+#include "game.h"
+
+/**
+ * @brief The state, see @ref game_state_new.
+ **/
+typedef struct game_state_s game_state;
+
+/**
+ * @brief Takes a state of a game, as it is now
+ * @details The game can then be changed or deleted, the state doesn't move.
+ * @param g the game
+ * @return the state, with one reference
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+game_state *game_state_new(cgame g);
+
+/**
+ * @brief Gives the state that follows a move
+ * @details The move isn't checked, see game_check_move.
+ * @param s the state, that is left unchanged
+ * @param i row index
+ * @param j column index
+ * @param sq the square to put in (i,j)
+ * @return the new state, with one reference
+ * @pre @p s must be a valid pointer toward a state.
+ * @pre @p i < game height
+ * @pre @p j < game width
+ * @pre @p sq must be either EMPTY, GRASS, TENT or TREE.
+ **/
+game_state *game_state_play(const game_state *s, uint i, uint j, square sq);
+
+/**
+ * @brief Gives the game of a state, to read it with the functions of the game
+ * @details The game has no history. It belongs to the state and must neither
+ * be changed nor deleted; use game_copy to play from it.
+ * @param s the state
+ * @return the game
+ * @pre @p s must be a valid pointer toward a state.
+ **/
+cgame game_state_game(const game_state *s);
+
+/**
+ * @brief Gives the number of moves played since the first state
+ * @param s the state
+ * @return the number of game_state_play from the state of game_state_new
+ * @pre @p s must be a valid pointer toward a state.
+ **/
+uint game_state_depth(const game_state *s);
+
+/**
+ * @brief Adds a reference to a state
+ * @param s the state
+ * @return @p s
+ * @pre @p s must be a valid pointer toward a state.
+ **/
+game_state *game_state_ref(game_state *s);
+
+/**
+ * @brief Removes a reference to a state, which is deleted with the last one
+ * @param s the state, or NULL
+ **/
+void game_state_delete(game_state *s);
+
+#endif  // __GAME_STATE_H__
@@ -4,6 +4,8 @@
 #include <string.h>
 #include "game.h"
 #include "game_aux.h"
+#include "game_ext.h"
+#include "game_state.h"
 
 /**test_game_print **/
 bool test_game_print(void) {
@@ -106,8 +108,55 @@ bool test_game_copy(void) {
   if (!test) {
     return false;
   }
+  // the copies share their squares until one of them changes
+  game g3 = game_copy(g2);
+  game_play_move(g2, 0, 0, TENT);
+  game_set_expected_nb_tents_col(g3, 3, 0);
+  if (game_get_square(g1, 0, 0) != EMPTY ||
+      game_get_square(g3, 0, 0) != EMPTY ||
+      game_get_square(g2, 0, 0) != TENT ||
+      game_get_expected_nb_tents_col(g1, 3) != 2 ||
+      game_get_expected_nb_tents_col(g2, 3) != 2 ||
+      game_get_current_nb_tents_col(g2, 0) != 1 ||
+      game_equal(g1, g2) || game_equal(g1, g3)) {
+    return false;
+  }
   game_delete(g1);
+  game_undo(g2);
+  game_set_expected_nb_tents_col(g3, 3, 2);
+  if (!game_equal(g2, g3)) {
+    return false;
+  }
   game_delete(g2);
+  game_delete(g3);
+  return true;
+}
+
+/**test_game_state **/
+bool test_game_state(void) {
+  // two branches from the same state, that stays as it was
+  game g = game_default();
+  game g_copy = game_copy(g);
+  game_state *root = game_state_new(g);
+  game_delete(g);
+  game_state *left = game_state_play(root, 0, 0, TENT);
+  game_state *right = game_state_play(root, 0, 0, GRASS);
+  game_state *next = game_state_play(game_state_ref(left), 7, 7, GRASS);
+  game_state_delete(left);
+  if (!game_equal(game_state_game(root), g_copy) ||
+      game_get_square(game_state_game(left), 0, 0) != TENT ||
+      game_get_square(game_state_game(right), 0, 0) != GRASS ||
+      game_get_square(game_state_game(next), 0, 0) != TENT ||
+      game_get_square(game_state_game(next), 7, 7) != GRASS ||
+      game_get_square(game_state_game(left), 7, 7) != EMPTY ||
+      game_state_depth(next) != 2) {
+    return false;
+  }
+  game_state_delete(root);
+  game_state_delete(left);
+  game_state_delete(right);
+  game_state_delete(next);
+  game_delete(g_copy);
   return true;
 }
 
@@ -126,6 +175,8 @@ int main(int argc, char *argv[]) {
     testPassed = test_game_new_empty();
   } else if (strcmp("game_copy", argv[1]) == 0) {
     testPassed = test_game_copy();
+  } else if (strcmp("game_state", argv[1]) == 0) {
+    testPassed = test_game_state();
   } else {
     fprintf(stderr, "Error: test \"%s\" not found!\n", argv[1]);
     exit(EXIT_FAILURE);
@@ -5,6 +5,7 @@
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "extra_functions.h"
 
 /*test_game_set_square*/
 bool test_game_set_square() {
@@ -209,6 +210,29 @@ bool test_game_undo(void) {
   if (!test) {
     return false;
   }
+
+  // a solution played at once is undone and redone at once
+  game solution = game_default_solution();
+  game_play_solution(game_test2, solution);
+  if (!game_equal(game_test2, solution)) {
+    return false;
+  }
+  game_undo(game_test2);
+  if (!game_equal(game_test, game_test2)) {
+    return false;
+  }
+  game_redo(game_test2);
+  if (!game_equal(game_test2, solution)) {
+    return false;
+  }
+  game_undo(game_test2);
+  game_undo(game_test2);
+  game_delete(game_test);
+  game_test = game_default();
+  if (!game_equal(game_test, game_test2)) {
+    return false;
+  }
+  game_delete(solution);
   game_delete(game_test);
   game_delete(game_test2);
   return true;
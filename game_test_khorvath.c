@@ -1,12 +1,32 @@
+#define _POSIX_C_SOURCE 200809L  // mkstemp
+
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include "arena.h"
+#include "extra_functions.h"
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
 #include "game_tools.h"
 #include "queue.h"
+#include "solution_cache.h"
+
+/**
+ * @brief Makes an empty file in the temporary directory, for a solution cache
+ * @param path "/tmp/tents_cache_XXXXXX", replaced by the name of the file
+ * @return false if the file couldn't be made
+ **/
+bool make_temp_file(char *path) {
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  return true;
+}
 
 bool test_game_play_move(void) {
   game g0 = game_default();
@@ -181,6 +201,78 @@ bool test_game_check_move(void) {
   return true;
 }
 
+bool test_game_is_losing_square(void) {
+  square squares[] = {TREE, TENT, 0, 0, TREE, 0, 0, 0, 0};
+  uint nb_tents_row[] = {1, 1, 0};
+  uint nb_tents_col[] = {1, 1, 0};
+  game g =
+      game_new_ext(3, 3, squares, nb_tents_row, nb_tents_col, false, false);
+  game_track_losing_squares(g);
+
+  // the losing squares follow the moves, and the undos and redos
+  if (game_is_losing_square(g, 0, 1)) {
+    return false;
+  }
+  game_play_move(g, 1, 0, TENT);
+  if (!game_is_losing_square(g, 1, 0) || !game_is_losing_square(g, 0, 1)) {
+    return false;
+  }
+  game_undo(g);
+  if (game_is_losing_square(g, 0, 1) || game_is_losing_square(g, 1, 0)) {
+    return false;
+  }
+  game_redo(g);
+  if (!game_is_losing_square(g, 1, 0)) {
+    return false;
+  }
+
+  // a copy, that doesn't track them, gives its own losing squares
+  game g_copy = game_copy(g);
+  game_undo(g);
+  if (!game_is_losing_square(g_copy, 1, 0) || game_is_losing_square(g, 0, 1)) {
+    return false;
+  }
+
+  // grass is losing when the row or the column has no room left for its tents
+  game_play_move(g, 1, 2, GRASS);
+  if (game_is_losing_square(g, 1, 2)) {
+    return false;
+  }
+  game_play_move(g, 1, 0, GRASS);
+  if (!game_is_losing_square(g, 1, 2) || !game_is_losing_square(g, 1, 0)) {
+    return false;
+  }
+  game_set_expected_nb_tents_row(g, 1, 0);
+  if (game_is_losing_square(g, 1, 2)) {
+    return false;
+  }
+
+  // grass is losing when it surrounds a tree, and a tent when it has no tree
+  game_restart(g);
+  game_play_move(g, 0, 1, GRASS);
+  if (game_is_losing_square(g, 0, 1)) {
+    return false;
+  }
+  game_play_move(g, 1, 0, GRASS);
+  if (!game_is_losing_square(g, 0, 1) || !game_is_losing_square(g, 1, 0)) {
+    return false;
+  }
+  game_set_expected_nb_tents_row(g, 2, 1);
+  game_set_expected_nb_tents_col(g, 2, 1);
+  game_play_move(g, 2, 2, TENT);
+  if (!game_is_losing_square(g, 2, 2)) {
+    return false;
+  }
+  game_set_square(g, 2, 1, TREE);
+  if (game_is_losing_square(g, 2, 2)) {
+    return false;
+  }
+
+  game_delete(g);
+  game_delete(g_copy);
+  return true;
+}
+
 bool test_game_is_over(void) {
   game g = game_default_solution();
   // test 1 if the correct default solution returns an error
@@ -408,6 +500,38 @@ bool test_game_new_empty_ext(void) {
   return true;
 }
 
+bool test_game_new_empty_ext_in(void) {
+  // games (and their copies) allocated in an arena, with small chunks so that
+  // many of them are needed
+  arena *a = arena_new(64);
+  game sol = game_default_solution();
+  game gm = NULL;
+  for (uint k = 0; k < 100; k++) {
+    gm = game_new_empty_ext_in(a, 4, 3, true, false);
+    if (game_get_square(gm, 3, 2) != EMPTY || !game_is_wrapping(gm)) {
+      return false;
+    }
+    game_play_move(gm, 3, 2, GRASS);
+    game_delete(gm);  // does nothing, the arena owns the game
+    game copy = game_copy_in(a, sol);
+    if (!game_equal(copy, sol)) {
+      return false;
+    }
+  }
+  if (game_get_square(gm, 3, 2) != GRASS) {
+    return false;
+  }
+  // a copy on the heap outlives the arena of the game
+  game kept = game_copy(gm);
+  arena_delete(a);
+  if (game_get_square(kept, 3, 2) != GRASS) {
+    return false;
+  }
+  game_delete(kept);
+  game_delete(sol);
+  return true;
+}
+
 bool test_game_load(void) {
   game g1 = game_default_solution();
   game_save(g1, "save_1.tnt");
@@ -521,10 +645,289 @@ bool test_game_solve(void) {
   if (!game_equal(g3, g3_copy)) {
     return false;
   }
+  // test on a wrapping game that has more columns than rows
+  square squares2[] = {TREE,  EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+                       EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+                       TREE,  EMPTY, EMPTY, TREE,  EMPTY, EMPTY,
+                       EMPTY, EMPTY, EMPTY, TREE,  TREE,  EMPTY};
+  uint nb_tents_row2[] = {1, 1, 2, 1};
+  uint nb_tents_col2[] = {2, 0, 1, 1, 1, 0};
+  game g4 =
+      game_new_ext(4, 6, squares2, nb_tents_row2, nb_tents_col2, true, false);
+  game g4_copy = game_copy(g4);
+  if (!game_solve(g4) || !game_is_over(g4)) {
+    return false;
+  }
+  if (game_get_square(g4, 0, 3) != TENT) {
+    return false;
+  }
+  if (game_nb_solutions(g4_copy) != 1) {
+    return false;
+  }
   game_delete(g1);
   game_delete(g2);
   game_delete(g3);
   game_delete(g3_copy);
+  game_delete(g4);
+  game_delete(g4_copy);
+  return true;
+}
+
+bool test_game_solve_thin_wrapping(void) {
+  square squares1[] = {EMPTY, EMPTY, EMPTY, EMPTY, TREE,
+                       EMPTY, EMPTY, EMPTY, EMPTY, EMPTY};
+  uint nb_tents_row1[] = {1, 0};
+  uint nb_tents_col1[] = {1, 0, 0, 0, 0};
+  game g1 =
+      game_new_ext(2, 5, squares1, nb_tents_row1, nb_tents_col1, true, false);
+  square squares2[] = {EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+                       EMPTY, EMPTY, EMPTY, EMPTY, TREE,  EMPTY};
+  uint nb_tents_row2[] = {1, 0, 0, 0, 0, 0};
+  uint nb_tents_col2[] = {1, 0};
+  game g2 =
+      game_new_ext(6, 2, squares2, nb_tents_row2, nb_tents_col2, true, false);
+  game games[] = {g1, g2};
+  for (uint k = 0; k < 2; k++) {
+    game g_copy = game_copy(games[k]);
+    bool solved = game_solve(games[k]) && game_is_over(games[k]) &&
+                  game_get_square(games[k], 0, 0) == TENT;
+    uint nb_sols = game_nb_solutions(g_copy);
+    game_delete(g_copy);
+    if (!solved || nb_sols != 1) {
+      return false;
+    }
+  }
+  game_delete(g1);
+  game_delete(g2);
+  return true;
+}
+
+bool test_game_hint(void) {
+  // the hints follow the solution, and never change the game
+  game g = game_default();
+  game solution = game_default_solution();
+  uint i, j;
+  square s;
+  while (game_hint(g, &i, &j, &s) != HINT_NONE) {
+    if (game_get_square(g, i, j) != EMPTY ||
+        game_get_square(solution, i, j) != s) {
+      return false;
+    }
+    game_play_move(g, i, j, s);
+  }
+  game g_copy = game_copy(g);
+  if (game_hint(g, &i, &j, &s) != HINT_NONE || !game_equal(g, g_copy)) {
+    return false;
+  }
+  game_delete(g);
+  game_delete(g_copy);
+  game_delete(solution);
+  return true;
+}
+
+bool test_game_canonical_hash(void) {
+  char path[] = "/tmp/tents_cache_XXXXXX";
+  if (!make_temp_file(path) || !solution_cache_open(path)) {
+    return false;
+  }
+  game g1 = game_default();
+  game g1_solution = game_default_solution();
+  game g1_solved = game_default();
+  if (!game_solve(g1_solved) || game_nb_solutions(g1) != 1) {
+    return false;
+  }
+  // a turned game has the canonical puzzle of the original one, and is
+  // solved from its cached solution
+  game_symmetry turn = {true, false, true, 0, 0};
+  game g2 = game_transform(g1, turn);
+  game g2_solution = game_transform(g1_solution, turn);
+  if (game_canonical_hash(g2) != game_canonical_hash(g1) ||
+      solution_cache_nb_solutions(g2) != 1 || !game_solve(g2) ||
+      !game_equal(g2, g2_solution)) {
+    return false;
+  }
+  // so is a translated wrapping game
+  square squares[] = {TREE,  EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+                      EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+                      TREE,  EMPTY, EMPTY, TREE,  EMPTY, EMPTY,
+                      EMPTY, EMPTY, EMPTY, TREE,  TREE,  EMPTY};
+  uint nb_tents_row[] = {1, 1, 2, 1};
+  uint nb_tents_col[] = {2, 0, 1, 1, 1, 0};
+  game g3 =
+      game_new_ext(4, 6, squares, nb_tents_row, nb_tents_col, true, false);
+  game_symmetry shift = {false, true, false, 1, 2};
+  game g4 = game_transform(g3, shift);
+  if (game_canonical_hash(g4) != game_canonical_hash(g3) ||
+      game_canonical_hash(g4) == game_canonical_hash(g2) ||
+      game_nb_solutions(g4) != 1) {
+    return false;
+  }
+  uint sym_i, sym_j;
+  game_symmetry_cell(g3, shift, 0, 3, &sym_i, &sym_j);
+  if (!game_solve(g4) || game_get_square(g4, sym_i, sym_j) != TENT) {
+    return false;
+  }
+  solution_cache_close();
+  remove(path);
+  game_delete(g1);
+  game_delete(g1_solution);
+  game_delete(g1_solved);
+  game_delete(g2);
+  game_delete(g2_solution);
+  game_delete(g3);
+  game_delete(g4);
+  return true;
+}
+
+bool test_solution_cache(void) {
+  char path[] = "/tmp/tents_cache_XXXXXX";
+  if (!make_temp_file(path) || !solution_cache_open(path)) {
+    return false;
+  }
+  // once a puzzle is in the cache, even after it is opened again, it isn't
+  // searched again, but a game where a wrong move was played isn't solved,
+  // nor changed
+  game solution = game_default_solution();
+  game g1 = game_default();
+  game g1_copy = game_default();
+  if (!game_solve(g1) || !game_equal(g1, solution) ||
+      game_nb_solutions(g1_copy) != 1) {
+    return false;
+  }
+  solution_cache_close();
+  if (!solution_cache_open(path)) {
+    return false;
+  }
+  game g2 = game_default();
+  if (solution_cache_nb_solutions(g2) != 1 || !game_solve(g2) ||
+      !game_equal(g2, solution)) {
+    return false;
+  }
+  game_restart(g2);
+  game_play_move(g2, 0, 1, TENT);
+  game g2_copy = game_copy(g2);
+  if (game_solve(g2) || !game_equal(g2, g2_copy)) {
+    return false;
+  }
+  // a key finds the same puzzle, and there is none without a cache
+  solution_cache_key key = solution_cache_key_new(g1_copy);
+  unsigned char squares[DEFAULT_SIZE * DEFAULT_SIZE];
+  if (solution_cache_key_nb_solutions(key) != 1 ||
+      !solution_cache_key_solution(key, g1_copy, squares)) {
+    return false;
+  }
+  for (uint i = 0; i < DEFAULT_SIZE; i++) {
+    for (uint j = 0; j < DEFAULT_SIZE; j++) {
+      if (squares[i * DEFAULT_SIZE + j] != game_get_square(solution, i, j)) {
+        return false;
+      }
+    }
+  }
+  solution_cache_key_delete(key);
+  solution_cache_close();
+  if (solution_cache_key_new(g1_copy) != NULL) {
+    return false;
+  }
+  remove(path);
+  game_delete(solution);
+  game_delete(g1);
+  game_delete(g1_copy);
+  game_delete(g2);
+  game_delete(g2_copy);
+  return true;
+}
+
+bool test_game_solve_ext(void) {
+  // a search stopped by its limits leaves the game unchanged
+  square squares1[] = {EMPTY, TREE,  EMPTY, EMPTY, EMPTY,
+                       EMPTY, EMPTY, TREE,  EMPTY};
+  uint nb_tents1[] = {1, 0, 1};
+  game g1 = game_new_ext(3, 3, squares1, nb_tents1, nb_tents1, false, false);
+  game g1_copy = game_copy(g1);
+  solve_options opts = {0, 1, 0};
+  uint nb_sols;
+  if (game_nb_solutions_ext(g1, &opts, &nb_sols) != SOLVE_TIMEOUT ||
+      nb_sols > 1 || !game_equal(g1, g1_copy)) {
+    return false;
+  }
+  solve_cancel(&opts);
+  if (game_solve_ext(g1, &opts) != SOLVE_CANCELLED ||
+      !game_equal(g1, g1_copy)) {
+    return false;
+  }
+  // without limits, the search goes to the end
+  if (game_nb_solutions_ext(g1, NULL, &nb_sols) != SOLVE_FOUND ||
+      nb_sols != 2) {
+    return false;
+  }
+  square squares2[] = {EMPTY, EMPTY, EMPTY, EMPTY, TREE,  EMPTY,
+                       EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY};
+  uint nb_tents_row2[] = {0, 1, 1, 0};
+  uint nb_tents_col2[] = {0, 1, 1};
+  game g2 =
+      game_new_ext(4, 3, squares2, nb_tents_row2, nb_tents_col2, false, true);
+  if (game_solve_ext(g2, NULL) != SOLVE_NONE) {
+    return false;
+  }
+  game_delete(g1);
+  game_delete(g1_copy);
+  game_delete(g2);
+  return true;
+}
+
+bool test_game_solve_partial(void) {
+  // the partial solve solves what it can
+  game g1 = game_default();
+  game g1_solution = game_default_solution();
+  if (game_solve_partial(g1, NULL) != SOLVE_FOUND ||
+      !game_equal(g1, g1_solution)) {
+    return false;
+  }
+  // and fills the rest of a game without solution in a single move
+  square squares[] = {EMPTY, EMPTY, EMPTY, EMPTY, TREE,  EMPTY,
+                      EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY};
+  uint nb_tents_row[] = {0, 1, 1, 0};
+  uint nb_tents_col[] = {0, 1, 1};
+  game g2 =
+      game_new_ext(4, 3, squares, nb_tents_row, nb_tents_col, false, true);
+  game g2_copy = game_copy(g2);
+  if (game_solve_partial(g2, NULL) != SOLVE_NONE || game_equal(g2, g2_copy)) {
+    return false;
+  }
+  for (uint k = 0; k < 4 * 3; k++) {
+    if (game_get_square(g2, k / 3, k % 3) != EMPTY &&
+        game_is_losing_square(g2, k / 3, k % 3)) {
+      return false;
+    }
+  }
+  game_undo(g2);
+  if (!game_equal(g2, g2_copy)) {
+    return false;
+  }
+  game_delete(g1);
+  game_delete(g1_solution);
+  game_delete(g2);
+  game_delete(g2_copy);
+  return true;
+}
+
+bool test_game_solve_lines(void) {
+  // on a wrapping game, the first and last cells of a line are next to each
+  // other when the rows and columns are propagated as a whole
+  square squares[] = {TREE,  EMPTY, EMPTY, TREE,  EMPTY, EMPTY, EMPTY,
+                      EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, TREE,  EMPTY,
+                      TREE,  EMPTY, EMPTY, EMPTY, EMPTY, EMPTY};
+  uint nb_tents_row[] = {2, 0, 2, 0};
+  uint nb_tents_col[] = {1, 1, 0, 1, 1};
+  game g = game_new_ext(4, 5, squares, nb_tents_row, nb_tents_col, true, false);
+  if (!game_solve(g) || !game_is_over(g)) {
+    return false;
+  }
+  if (game_get_square(g, 0, 1) != TENT || game_get_square(g, 0, 4) != TENT ||
+      game_get_square(g, 2, 0) != TENT || game_get_square(g, 2, 3) != TENT) {
+    return false;
+  }
+  game_delete(g);
   return true;
 }
 
@@ -536,6 +939,8 @@ int main(int argc, char* argv[]) {
     testPassed = test_game_play_move();
   } else if (strcmp("game_check_move", argv[1]) == 0) {
     testPassed = test_game_check_move();
+  } else if (strcmp("game_is_losing_square", argv[1]) == 0) {
+    testPassed = test_game_is_losing_square();
   } else if (strcmp("game_is_over", argv[1]) == 0) {
     testPassed = test_game_is_over();
   } else if (strcmp("game_fill_grass_row", argv[1]) == 0) {
@@ -546,6 +951,8 @@ int main(int argc, char* argv[]) {
     testPassed = test_game_restart();
   } else if (strcmp("game_new_empty_ext", argv[1]) == 0) {
     testPassed = test_game_new_empty_ext();
+  } else if (strcmp("game_new_empty_ext_in", argv[1]) == 0) {
+    testPassed = test_game_new_empty_ext_in();
   } else if (strcmp("game_new_ext", argv[1]) == 0) {
     testPassed = test_game_new_ext();
   } else if (strcmp("game_load", argv[1]) == 0) {
@@ -554,6 +961,20 @@ int main(int argc, char* argv[]) {
     testPassed = test_game_save();
   } else if (strcmp("game_solve", argv[1]) == 0) {
     testPassed = test_game_solve();
+  } else if (strcmp("game_solve_thin_wrapping", argv[1]) == 0) {
+    testPassed = test_game_solve_thin_wrapping();
+  } else if (strcmp("game_hint", argv[1]) == 0) {
+    testPassed = test_game_hint();
+  } else if (strcmp("solution_cache", argv[1]) == 0) {
+    testPassed = test_solution_cache();
+  } else if (strcmp("game_solve_ext", argv[1]) == 0) {
+    testPassed = test_game_solve_ext();
+  } else if (strcmp("game_solve_partial", argv[1]) == 0) {
+    testPassed = test_game_solve_partial();
+  } else if (strcmp("game_solve_lines", argv[1]) == 0) {
+    testPassed = test_game_solve_lines();
+  } else if (strcmp("game_canonical_hash", argv[1]) == 0) {
+    testPassed = test_game_canonical_hash();
   } else {
     fprintf(stderr, "Error: test \"%s\" not found!\n", argv[1]);
     exit(EXIT_FAILURE);
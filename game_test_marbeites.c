@@ -136,6 +136,24 @@ bool test_game_get_current_nb_tents_row(int row) {
     return false;
   }
   game_delete(game);
+  // wide rows are counted in several pieces
+  game = game_new_empty_ext(3, 70, false, false);
+  for (uint j = 0; j < 70; j += 3) {
+    game_set_square(game, 1, j, TENT);
+  }
+  if (game_get_current_nb_tents_row(game, 1) != 24 ||
+      game_get_current_nb_tents_row(game, 0) != 0) {
+    return false;
+  }
+  game_delete(game);
+  game = game_new_empty_ext(1, 5000, false, false);
+  for (uint j = 0; j < 5000; j += 7) {
+    game_set_square(game, 0, j, TENT);
+  }
+  if (game_get_current_nb_tents_row(game, 0) != 715) {
+    return false;
+  }
+  game_delete(game);
   return true;
 };
 
@@ -175,6 +193,16 @@ bool test_game_get_current_nb_tents_col(int col) {
     return false;
   }
   game_delete(game);
+  // tall columns are counted in several pieces
+  game = game_new_empty_ext(70, 3, false, false);
+  for (uint i = 0; i < 70; i += 3) {
+    game_set_square(game, i, 1, TENT);
+  }
+  if (game_get_current_nb_tents_col(game, 1) != 24 ||
+      game_get_current_nb_tents_col(game, 2) != 0) {
+    return false;
+  }
+  game_delete(game);
   return true;
 };
 
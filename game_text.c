@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "game.h"
+#include "extra_functions.h"
 #include "game_aux.h"
 #include "game_ext.h"
 #include "game_tools.h"
@@ -20,7 +21,7 @@ int main(int argc, char *argv[]) {
     printf("Enter type of square, row number and column number:\n");
     int ret1 = scanf("%c", &c);
     if (c == 'h') {
-      printf("Press r to restart the game and q to quit\n");
+      printf("Press r to restart the game, i for a hint and q to quit\n");
     } else if (c == 'r') {
       printf("You restarted the game\n");
       game_restart(current_game);
@@ -29,6 +30,17 @@ int main(int argc, char *argv[]) {
     } else if (c == 'q') {
       printf("shame\n");
       return EXIT_SUCCESS;
+    } else if (c == 'i') {
+      square s;
+      hint_rule rule = game_hint(current_game, &i, &j, &s);
+      if (rule == HINT_NONE) {
+        printf("No hint: a guess is needed, or a square is wrong\n");
+      } else {
+        char *reasons[] = {"", "the rules of the game", "a tree around it",
+                           "the tents left to place around it"};
+        printf("Hint: put %c in the (%u, %u) position, because of %s\n",
+               s == TENT ? 't' : 'g', i, j, reasons[rule]);
+      }
     } else if (c == 'z') {
       game_undo(current_game);
       game_print(current_game);
@@ -1,26 +1,180 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
 #include "game_tools.h"
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "arena.h"
 #include "extra_functions.h"
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_scan.h"
+#include "game_state.h"
 #include "queue.h"
+#include "solution_cache.h"
 
-static uint game_solve_rec(game g, bool count_solution, uint *p_nb_sol);
-static int game_fill(game g);
-static int game_extra_check_move(cgame g, uint i, uint j, square s);
-static uint nb_empty_cells_to_the_left(cgame g, uint i, uint j);
-static uint nb_empty_cells_to_the_right(cgame g, uint i, uint j);
-static uint nb_empty_cells_above(cgame g, uint i, uint j);
-static uint nb_empty_cells_below(cgame g, uint i, uint j);
-static uint size_of_section(cgame g, uint i, uint j, bool vertical);
-static uint nb_possible_tent_placements_row(cgame g, uint i);
-static uint nb_possible_tent_placements_col(cgame g, uint j);
-static uint *make_array_of_all_trees(cgame g);
+#define NO_CELL UINT_MAX
+
+enum {
+  MAX_NOGOOD_SIZE = 4,       /**< bigger conflicts aren't recorded */
+  MAX_NOGOOD_CANDIDATES = 8, /**< squares a conflict is looked for among */
+  MAX_NOGOODS = 4096,        /**< nogoods recorded by a search */
+  LEARNING_START = 256       /**< tents tried before nogoods are recorded */
+};
+
+/**
+ * @brief What a cell of a row or column allows, for line_placements.
+ **/
+enum {
+  LINE_NO_TENT = 0, /**< the cell can't hold a tent */
+  LINE_FREE = 1,    /**< the cell may hold a tent or not */
+  LINE_TENT = 2     /**< the cell holds a tent */
+};
+
+/**
+ * @brief What the placements of a line found by line_placements have in a
+ * cell (both flags can be set).
+ **/
+enum {
+  PLACED_NO_TENT = 1, /**< some placement has no tent in the cell */
+  PLACED_TENT = 2     /**< some placement has a tent in the cell */
+};
+
+/**
+ * @brief Squares that can't all be in a solution (a nogood).
+ **/
+typedef struct {
+  uint nb_squares;
+  uint cells[MAX_NOGOOD_SIZE];
+  unsigned char squares[MAX_NOGOOD_SIZE];
+  uint next[MAX_NOGOOD_SIZE];  // next entry in the list of the cell, see below
+} nogood;
+
+/**
+ * @brief The nogoods recorded by a search.
+ * @details Each nogood is listed under each of its cells, so that the ones
+ *that may forbid a square are found at once. An entry of a list is
+ *k * MAX_NOGOOD_SIZE + p for the p-th square of the k-th nogood.
+ **/
+typedef struct {
+  nogood *nogoods;  // NULL until the search starts recording them
+  uint nb_nogoods;
+  uint *first;  // first entry of the list of each cell, or NO_CELL
+} nogood_store;
+
+/**
+ * @brief The neighbour tables used by the solver.
+ * @details They are computed once per call to game_solve or game_nb_solutions,
+ * and take wrapping into account, so that the propagation never has to
+ * recompute (and allocate) the cells around a given one. They live in an
+ * arena, which also holds the scratch memory of the solver.
+ **/
+typedef struct {
+  uint nb_rows;
+  uint nb_cols;
+  uint *around;    // the 8 cells around each cell (or NO_CELL), see the enum
+  uint nb_trees;   // number of trees in the game
+  uint *trees;     // row and column index of each tree
+  arena *scratch;  // arena of the tables and of the solver scratch memory
+  nogood_store *learned;  // nogoods of the search running, see solve_rec
+  bool whole_lines;       // fill propagates each line at once, see fill
+} neighbours;
+
+/**
+ * @brief Directions used to index the neighbour table.
+ * @details They follow the order of make_array_of_all_adjacent_cells, so the
+ * orthogonal neighbours are the even ones.
+ **/
+enum {
+  LEFT = 0,       /**< cell on the left */
+  UP_LEFT = 1,    /**< cell above on the left */
+  UP = 2,         /**< cell above */
+  UP_RIGHT = 3,   /**< cell above on the right */
+  RIGHT = 4,      /**< cell on the right */
+  DOWN_RIGHT = 5, /**< cell below on the right */
+  DOWN = 6,       /**< cell below */
+  DOWN_LEFT = 7,  /**< cell below on the left */
+};
+
+/**
+ * @brief Where the search of the solver has to stop.
+ **/
+typedef struct {
+  const solve_options *options; // NULL if there are no limits
+  double deadline;              // on the clock of now_seconds, 0 if none
+  unsigned long nb_nodes;       // number of tents tried
+  solve_status stopped;         // why the search stopped, SOLVE_FOUND if not
+} search_limits;
+
+/**
+ * @brief A decision of the search of the solver: a tent tried in a cell.
+ **/
+typedef struct {
+  uint cell;          // the cell of the tent, as i * nb_cols + j
+  uint next_cell;     // where the scan for an empty cell goes on
+  bool stop;          // true once the cell can be neither a tent nor grass
+  uint nb_sol_before; // what the search after the last tent gave
+  uint nb_decisions;  // squares decided by the search before the tent
+} search_frame;
+
+enum {
+  PARTIAL_QUEUE_SIZE = 256 /**< states kept by game_solve_partial */
+};
+
+/**
+ * @brief A state reached by game_solve_partial, and how good it is.
+ **/
+typedef struct {
+  game_state *state;
+  uint next_cell;     // cells before it are decided, or left empty for good
+  uint nb_empty;      // empty cells left in the state
+  uint nb_skipped;    // cells left empty since neither square fitted
+  bool propagate;     // false once a cell is skipped (see solve_partial)
+} partial_node;
+
+/**
+ * @brief The best states of game_solve_partial that are yet to be expanded.
+ **/
+typedef struct {
+  partial_node *nodes;
+  uint size;
+  uint capacity;
+} partial_queue;
+
+static neighbours *neighbours_new(cgame g);
+static void neighbours_delete(neighbours *nb);
+static uint *make_array_of_all_trees(cgame g, arena *a);
 static uint game_nb_trees(cgame g);
-static uint fill_according_to_trees(game g);
+static uint nb_trees_around_cell(cgame g, const neighbours *nb, uint cell);
+static uint fill_according_to_trees(game g, const neighbours *nb);
+static bool hint_according_to_trees(cgame g, const neighbours *nb, uint *p_i,
+                                    uint *p_j);
+static bool has_moves(cgame g);
+static bool solve_from_cache(game g, solution_cache_key key);
+static double now_seconds(void);
+static void limits_init(search_limits *limits, const solve_options *opts);
+static bool out_of_budget(search_limits *limits);
+static void restore_squares(game g, const unsigned char *squares);
+static unsigned char *save_squares(cgame g);
+static void original_cell(cgame g, const game_symmetry *sym, uint i, uint j,
+                          uint *p_i, uint *p_j);
+static uint puzzle_value(cgame g, const game_symmetry *sym, uint k);
+static bool nogood_forbids(const nogood_store *store, cgame g, uint cell,
+                           square s);
+static void nogood_add(nogood_store *store, const uint *cells,
+                       const unsigned char *squares, uint nb_squares);
+static void nogood_start(nogood_store *store, arena *a, uint nb_cells);
+static void nogood_clear(nogood_store *store);
+static bool line_placements(const unsigned char *kinds, uint len, uint nb_tents,
+                            arena *a, unsigned char *placed);
+static bool partial_node_better(const partial_node *a, const partial_node *b);
+static void partial_queue_push(partial_queue *q, partial_node node);
+static bool partial_queue_pop(partial_queue *q, partial_node *p_node);
+static int compare_symmetries(cgame g, const game_symmetry *a,
+                              const game_symmetry *b);
 
 game game_load(char *filename) {
   FILE *f;
@@ -84,6 +238,12 @@ void game_save(cgame g, char *filename) {
     fprintf(stderr, "file couldn't open!\n");
     exit(EXIT_FAILURE);
   }
+  game_write(g, f);
+  fclose(f);
+}
+
+void game_write(cgame g, FILE *f) {
+  test_pointer(g);
   fprintf(f, "%u %u ", game_nb_rows(g), game_nb_cols(g));
   fprintf(f, "%d ", game_is_wrapping(g));
   fprintf(f, "%d\n", game_is_diagadj(g));
@@ -109,375 +269,75 @@ void game_save(cgame g, char *filename) {
     }
     fprintf(f, "\n");
   }
-  fclose(f);
 }
 
+
 /**
- * @brief The recursive function that goes with function game_solve and
- *game_nb_solutioos
- * @details This function checks that playing a move in a square is a regular
- * move (see @ref index).
+ * @brief Computes the neighbour tables of a game
+ * @details Cells are stored as row-major indices.
  * @param g the game
- * @param count_solutions true if called by game_nb_solutions, false if called
- *by game_solve
- * @param p_nb_sol_found pointer to the number of solutions found
- * @return the number of solutions found
+ * @return the neighbour tables, to be freed with neighbours_delete
  * @pre @p g must be a valid pointer toward a game structure.
  **/
-uint game_solve_rec(game g, bool count_solutions, uint *p_nb_sol_found) {
-  if (game_is_over(g)) {
-    return 1;
-  }
-  if (count_solutions == true) {
-    game_fill(g);
-  }
-  uint nb_moves;
-  bool stop = false;
-  uint nb_sol_before = 0;
-  for (uint i = 0; i < game_nb_rows(g); i++) {
-    if (stop == true) {
-      break;
-    }
-    for (uint j = 0; j < game_nb_cols(g); j++) {
-      if (stop == true) {
-        break;
-      }
-      if (game_get_square(g, i, j) == EMPTY) {
-        game_play_move(g, i, j, TENT);
-        nb_moves = game_fill(g);
-        if (nb_moves == -1) {
-          game_play_move(g, i, j, GRASS);
-          continue;
-        }
-        nb_sol_before = game_solve_rec(g, count_solutions, p_nb_sol_found);
-        if (game_is_over(g)) {
-          *p_nb_sol_found += 1;
-          if (!count_solutions) {
-            return true;
-          }
-        }
-        uint test = 0;
-        while (game_get_square(g, i, j) != EMPTY) {
-          test += 1;
-          game_undo(g);
-        }
-        if (count_solutions) {
-          if (game_extra_check_move(g, i, j, GRASS) == REGULAR) {
-            game_play_move(g, i, j, GRASS);
-          } else {
-            stop = true;
-          }
-        }
-      }
-    }
-  }
-  return *p_nb_sol_found + nb_sol_before;
-}
-
-bool game_solve(game g) {
-  test_pointer(g);
-  uint nb_moves = game_fill(g);
-  if (nb_moves == -1) {
-    return false;
-  }
-  if (game_is_over(g)) {
-    return true;
-  }
-  uint nb_solution_found = 0;
-  uint nb_sols = game_solve_rec(g, false, &nb_solution_found);
-  if (nb_sols == 0) {
-    for (uint i = 0; i < nb_moves; i++) {
-      game_undo(g);
-    }
-    return false;
-  }
-  return true;
-}
-
-uint game_nb_solutions(game g) {
+neighbours *neighbours_new(cgame g) {
   test_pointer(g);
-  uint nb_moves = game_fill(g);
-  if (nb_moves == -1) {
-    return 0;
-  }
-  if (game_is_over(g)) {
-    return 1;
-  }
-  uint nb_solution_found = 0;
-  uint game_is_solved = game_solve_rec(g, true, &nb_solution_found);
-
-  if (game_is_solved == 0) {
-    for (uint i = 0; i < nb_moves; i++) {
-      game_undo(g);
-    }
-    return 0;
-  }
-  return nb_solution_found;
-}
-
-/**
- * @brief Checks in a more detailed manner if a given move in a square is
- *regular
- * @details This function checks that playing a move in a square is a regular
- * move (see @ref index).
- * @param g the game
- * @param i row index
- * @param j column index
- * @param s the square value
- * @return either REGULAR, LOSING or ILLEGAL depending on the move
- * @pre @p g must be a valid pointer toward a game structure.
- * @pre @p i < game width
- * @pre @p j < game height
- * @pre @p s must be either EMPTY, GRASS, TENT or TREE.
- **/
-int game_extra_check_move(cgame g, uint i, uint j, square s) {
-  if (game_check_move(g, i, j, s) == LOSING) {
-    return LOSING;
-  } else if (game_check_move(g, i, j, s) == ILLEGAL) {
-    return ILLEGAL;
-  }
-  // First we find the coordinates of the cells around (depends on wrapping)
-  uint above_i = game_nb_rows(g);
-  uint below_i = game_nb_rows(g);
-  uint left_j = game_nb_cols(g);
-  uint right_j = game_nb_cols(g);
-  if (i != 0) {
-    above_i = i - 1;
-  } else if (i == 0 && game_is_wrapping(g)) {
-    above_i = game_nb_rows(g) - 1;
-  }
-  if (i != game_nb_rows(g) - 1) {
-    below_i = i + 1;
-  } else if ((i == game_nb_rows(g) - 1) && game_is_wrapping(g)) {
-    below_i = 0;
-  }
-  if (j != 0) {
-    left_j = j - 1;
-  } else if (j == 0 && game_is_wrapping(g)) {
-    left_j = game_nb_rows(g) - 1;
-  }
-  if (j != game_nb_rows(g) - 1) {
-    right_j = j + 1;
-  } else if ((j == game_nb_rows(g) - 1) && game_is_wrapping(g)) {
-    right_j = 0;
-  }
-  uint sec_size_hor = size_of_section(g, i, j, false);
-  uint sec_size_vert = size_of_section(g, i, j, true);
-  /* If in the given row (or column) in which the cell is,
-  there is the same number of possible placements than the number of tents we
-  have to place, then, if the size of the section in which the cell is is odd,
-  we can make some deductions:
-  - if the cell is in an "odd" position, then it has to contain a tent
-  - if the cell is in an "even" position, then it has to contain grass
-  for example:
-  x  --   x  -- x: 5
-  There are 5 possible tent placements and we have to place 5 tents
-  So we can make 4 deductions:
-  - the first section in even, so we can't deduct anything
-  - the second one is odd, so we know that the cells in position 1 and 3 of that
-  section have to be tents, and the cell in position 2 has to be grass
-  - the third section is even so we can't deduct anything
-  - the fourth section is odd so we can place a tent
-  The same goes for columns
-  */
-  if (nb_possible_tent_placements_row(g, i) ==
-      (game_get_expected_nb_tents_row(g, i) -
-       game_get_current_nb_tents_row(g, i))) {
-    if (sec_size_hor % 2 == 1 && sec_size_hor != game_nb_cols(g)) {
-      if (nb_empty_cells_to_the_left(g, i, j) % 2 == 1) {
-        if (s == TENT) {
-          return LOSING;
-        }
-      } else {
-        if (s == GRASS) {
-          return LOSING;
-        }
-      }
-    }
-  } else if (nb_possible_tent_placements_col(g, j) ==
-             (game_get_expected_nb_tents_col(g, j) -
-              game_get_current_nb_tents_col(g, j))) {
-    if (sec_size_vert % 2 == 1 && sec_size_vert != game_nb_rows(g)) {
-      if (nb_empty_cells_above(g, i, j) % 2 == 1) {
-        if (s == TENT) {
-          return LOSING;
-        }
-      } else {
-        if (s == GRASS) {
-          return LOSING;
-        }
-      }
-    }
-  }
-  /*
-  If the game isn't diagadj, we can make some more deductions
-  We can look at the row above (or below) or the column on the left (or right)
-
-  For example:
-  0:x  -    x*x:4
-  1:  x- x -x--:1
-  We can see that row 0 still has 3 tents to place and there are only 3 possible
-  tent placements (since in a section of 4, there can be a maximum of 2 tents
-  and in a section of 2 there can only be 1 tent) We can therefore make some
-  deductions:
-  - in the first section of row 0, there has to be a tent, so either way, the
-  cell in row 1 col 1 cannot be a tent (a tent will always see it)
-  - in the second section (size 4) of row 0, there has to be 2 tents
-  no matter how you place them, they will always see row 1 col 4 and row 1 col 6
-  so these cells have to be grass
-  */
-  if (s == TENT && !game_is_diagadj(g)) {
-    if (above_i != game_nb_rows(g)) {
-      if (nb_possible_tent_placements_row(g, above_i) ==
-          (game_get_expected_nb_tents_row(g, above_i) -
-           game_get_current_nb_tents_row(g, above_i))) {
-        if (game_get_square(g, above_i, j) == EMPTY) {
-          return LOSING;
-        }
-      }
-    }
-    if (below_i != game_nb_rows(g)) {
-      if (nb_possible_tent_placements_row(g, below_i) ==
-          (game_get_expected_nb_tents_row(g, below_i) -
-           game_get_current_nb_tents_row(g, below_i))) {
-        if (game_get_square(g, below_i, j) == EMPTY) {
-          return LOSING;
-        }
-      }
-    }
-    if (left_j != game_nb_cols(g)) {
-      if (nb_possible_tent_placements_col(g, left_j) ==
-          (game_get_expected_nb_tents_col(g, left_j) -
-           game_get_current_nb_tents_col(g, left_j))) {
-        if (game_get_square(g, i, left_j) == EMPTY) {
-          return LOSING;
-        }
-      }
-    }
-    if (right_j != game_nb_cols(g)) {
-      if (nb_possible_tent_placements_col(g, right_j) ==
-          (game_get_expected_nb_tents_col(g, right_j) -
-           game_get_current_nb_tents_col(g, right_j))) {
-        if (game_get_square(g, i, right_j) == EMPTY) {
-          return LOSING;
-        }
-      }
-    }
-  }
-  // check number 3
-  if (s == TENT && !game_is_diagadj(g)) {
-    if (above_i != game_nb_rows(g) && left_j != game_nb_cols(g) &&
-        right_j != game_nb_cols(g)) {
-      if (nb_possible_tent_placements_row(g, above_i) ==
-          (game_get_expected_nb_tents_row(g, above_i) -
-           game_get_current_nb_tents_row(g, above_i) + 1)) {
-        if (game_get_square(g, above_i, left_j) == EMPTY &&
-            size_of_section(g, above_i, left_j, false) == 1 &&
-            game_get_square(g, above_i, right_j) == EMPTY &&
-            size_of_section(g, above_i, right_j, false) == 1) {
-          return LOSING;
-        }
-      }
-    }
-    if (below_i != game_nb_rows(g) && left_j != game_nb_cols(g) &&
-        right_j != game_nb_cols(g)) {
-      if (nb_possible_tent_placements_row(g, below_i) ==
-          (game_get_expected_nb_tents_row(g, below_i) -
-           game_get_current_nb_tents_row(g, below_i) + 1)) {
-        if (game_get_square(g, below_i, left_j) == EMPTY &&
-            size_of_section(g, below_i, left_j, false) == 1 &&
-            game_get_square(g, below_i, right_j) == EMPTY &&
-            size_of_section(g, below_i, right_j, false) == 1) {
-          return LOSING;
-        }
-      }
-    }
-    if (left_j != game_nb_cols(g) && above_i != game_nb_rows(g) &&
-        below_i != game_nb_rows(g)) {
-      if (nb_possible_tent_placements_col(g, left_j) ==
-          (game_get_expected_nb_tents_col(g, left_j) -
-           game_get_current_nb_tents_col(g, left_j) + 1)) {
-        if (game_get_square(g, above_i, left_j) == EMPTY &&
-            size_of_section(g, above_i, left_j, true) == 1 &&
-            game_get_square(g, below_i, left_j) == EMPTY &&
-            size_of_section(g, below_i, left_j, true) == 1) {
-          return LOSING;
+  arena *scratch = arena_new(0);
+  neighbours *nb = (neighbours *)arena_alloc(scratch, sizeof(neighbours));
+  nb->scratch = scratch;
+  nb->learned = (nogood_store *)arena_alloc(scratch, sizeof(nogood_store));
+  nb->learned->nogoods = NULL;
+  nb->learned->nb_nogoods = 0;
+  nb->learned->first = NULL;
+  nb->whole_lines = true;
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  bool wrapping = game_is_wrapping(g);
+  nb->nb_rows = nb_rows;
+  nb->nb_cols = nb_cols;
+  nb->around =
+      (uint *)arena_alloc(scratch, sizeof(uint) * nb_rows * nb_cols * 8);
+  // the trees never move during the search
+  nb->nb_trees = game_nb_trees(g);
+  nb->trees = make_array_of_all_trees(g, scratch);
+  // row and column offsets of each direction
+  int di[] = {0, -1, -1, -1, 0, 1, 1, 1};
+  int dj[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      uint *around = nb->around + (i * nb_cols + j) * 8;
+      for (uint d = 0; d < 8; d++) {
+        int cell_i = (int)i + di[d];
+        int cell_j = (int)j + dj[d];
+        // on the borders, there is a neighbour only if the game is wrapping
+        if (wrapping) {
+          cell_i = (cell_i + nb_rows) % nb_rows;
+          cell_j = (cell_j + nb_cols) % nb_cols;
         }
-      }
-    }
-    if (right_j != game_nb_cols(g) && above_i != game_nb_rows(g) &&
-        below_i != game_nb_rows(g)) {
-      if (nb_possible_tent_placements_col(g, right_j) ==
-          (game_get_expected_nb_tents_col(g, right_j) -
-           game_get_current_nb_tents_col(g, right_j) + 1)) {
-        if (game_get_square(g, above_i, right_j) == EMPTY &&
-            size_of_section(g, above_i, right_j, true) == 1 &&
-            game_get_square(g, below_i, right_j) == EMPTY &&
-            size_of_section(g, below_i, right_j, true) == 1) {
-          return LOSING;
+        if (cell_i < 0 || cell_i >= (int)nb_rows || cell_j < 0 ||
+            cell_j >= (int)nb_cols) {
+          around[d] = NO_CELL;
+        } else {
+          around[d] = cell_i * nb_cols + cell_j;
         }
       }
     }
   }
-
-  return REGULAR;
+  return nb;
 }
 
 /**
- * @brief Fills the game to the maximum
- * @details This function checks each cell: if grass is losing, it places a
- *tent, if tent is losing, it places grass
- * @param g the game
- * @return the total number of moves that have been made
- * @pre @p g must be a valid pointer toward a game structure.
+ * @brief Frees the neighbour tables, along with the solver scratch memory
+ * @param nb the neighbour tables
  **/
-int game_fill(game g) {
-  if (g == NULL) {
-    fprintf(stderr, "Function called on NULL pointer\n");
-    exit(EXIT_FAILURE);
-  }
-  int nb_moves = 1;
-  int total_nb_moves = 0;
-  while (nb_moves != 0) {
-    nb_moves = 0;
-    for (uint i = 0; i < game_nb_rows(g); i++) {
-      for (uint j = 0; j < game_nb_cols(g); j++) {
-        if (game_get_square(g, i, j) == EMPTY) {
-          int tent_move = game_extra_check_move(g, i, j, TENT);
-          int grass_move = game_extra_check_move(g, i, j, GRASS);
-          if (tent_move == LOSING && grass_move == REGULAR) {
-            game_play_move(g, i, j, GRASS);
-            nb_moves++;
-            total_nb_moves++;
-          } else if (grass_move == LOSING && tent_move == REGULAR) {
-            game_play_move(g, i, j, TENT);
-            nb_moves++;
-            total_nb_moves++;
-          } else if (tent_move == LOSING && grass_move == LOSING) {
-            for (int nb = 0; nb < total_nb_moves + 1; nb++) {
-              game_undo(g);
-            }
-            return -1;
-          }
-        }
-      }
-    }
-    if (!game_is_over(g)) {
-      uint cpt = fill_according_to_trees(g);
-      nb_moves += cpt;
-      total_nb_moves += cpt;
-    }
+void neighbours_delete(neighbours *nb) {
+  if (nb != NULL) {
+    arena_delete(nb->scratch);
   }
-  return total_nb_moves;
 }
 
-uint *make_array_of_all_trees(cgame g) {
+uint *make_array_of_all_trees(cgame g, arena *a) {
   test_pointer(g);
-  uint *array = (uint *)malloc(sizeof(uint) * game_nb_trees(g) * 2);
-  if (array == NULL) {
-    fprintf(stderr, "Not enough memory\n");
-    exit(EXIT_FAILURE);
-  }
+  uint *array = (uint *)arena_alloc(a, sizeof(uint) * game_nb_trees(g) * 2);
   uint cpt = 0;
   for (uint i = 0; i < game_nb_rows(g); i++) {
     for (uint j = 0; j < game_nb_cols(g); j++) {
@@ -504,55 +364,51 @@ uint game_nb_trees(cgame g) {
   return cpt;
 }
 
-uint nb_trees_around_cell(cgame g, uint i, uint j) {
-  test_pointer(g);
-  test_i_value(g, i);
-  test_j_value(g, j);
-  uint *cells_around = make_array_of_ortho_adjacent_cells(g, i, j);
-  uint cell_i, cell_j;
-  uint ind = 1;
+/**
+ * @brief Gives the number of trees orthogonally adjacent to a cell
+ * @param g the game
+ * @param nb the neighbour tables of the game
+ * @param cell row-major index of the cell
+ * @return the number of trees around the cell
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint nb_trees_around_cell(cgame g, const neighbours *nb, uint cell) {
+  const uint *around = nb->around + cell * 8;
   uint nb_trees = 0;
-  while (cells_around[ind - 1] < game_nb_rows(g)) {
-    cell_i = cells_around[ind - 1];
-    cell_j = cells_around[ind];
-    if (game_get_square(g, cell_i, cell_j) == TREE) {
+  for (uint d = 0; d < 8; d += 2) {
+    if (around[d] != NO_CELL &&
+        game_get_square(g, around[d] / nb->nb_cols, around[d] % nb->nb_cols) ==
+            TREE) {
       nb_trees++;
     }
-    ind += 2;
   }
-  free(cells_around);
   return nb_trees;
 }
 
-uint fill_according_to_trees(game g) {
+uint fill_according_to_trees(game g, const neighbours *nb) {
   uint nb_moves = 0;
   uint cpt = 1;  // counts how many trees were added in that round
-  uint *trees = make_array_of_all_trees(g);
-  uint *taken_trees = (uint *)malloc(sizeof(uint) * game_nb_trees(g) * 2);
-  if (taken_trees == NULL) {
-    fprintf(stderr, "Not enough memory\n");
-    exit(EXIT_FAILURE);
-  }
-  uint *taken_tents = (uint *)malloc(sizeof(uint) * game_nb_trees(g) * 2);
-  if (taken_tents == NULL) {
-    fprintf(stderr, "Not enough memory\n");
-    exit(EXIT_FAILURE);
-  }
+  uint nb_cols = nb->nb_cols;
+  const uint *trees = nb->trees;
+  // the scratch arrays are given back to the arena when we are done
+  arena_mark mark = arena_get_mark(nb->scratch);
+  uint *taken_trees =
+      (uint *)arena_alloc(nb->scratch, sizeof(uint) * nb->nb_trees * 2);
+  uint *taken_tents =
+      (uint *)arena_alloc(nb->scratch, sizeof(uint) * nb->nb_trees * 2);
   uint nb_taken = 0;
   while (cpt != 0) {
     cpt = 0;
     bool already_has_a_tent = false;
-    for (uint i = 0; i < game_nb_trees(g) * 2; i += 2) {
+    for (uint i = 0; i < nb->nb_trees * 2; i += 2) {
       if (i % 2 == 1) {
         continue;
       }
       // first check if the tree is already taken
       already_has_a_tent = false;
-      // printf("taken trees:\n");
-      for (uint nb = 0; nb < nb_taken * 2; nb += 2) {
-        // printf("%u %u\n", taken_trees[nb], taken_trees[nb+1]);
-        if (trees[i] == taken_trees[nb] &&
-            trees[i + 1] == taken_trees[nb + 1]) {
+      for (uint t = 0; t < nb_taken * 2; t += 2) {
+        if (trees[i] == taken_trees[t] &&
+            trees[i + 1] == taken_trees[t + 1]) {
           already_has_a_tent = true;
           break;
         }
@@ -560,21 +416,23 @@ uint fill_according_to_trees(game g) {
       if (already_has_a_tent) {
         continue;
       }
-      uint *adj_cells_tree =
-          make_array_of_ortho_adjacent_cells(g, trees[i], trees[i + 1]);
-      uint ind = 1;
+      const uint *adj_cells_tree =
+          nb->around + (trees[i] * nb_cols + trees[i + 1]) * 8;
       uint cell_i, cell_j;
       uint nb_tent_placements = 0;
       uint possible_placement_i, possible_placement_j;
       uint nb_tents_avail = 0;
       uint nb_tents_not_avail = 0;
-      while (adj_cells_tree[ind - 1] < game_nb_rows(g)) {
-        cell_i = adj_cells_tree[ind - 1];
-        cell_j = adj_cells_tree[ind];
+      for (uint d = 0; d < 8; d += 2) {
+        if (adj_cells_tree[d] == NO_CELL) {
+          continue;
+        }
+        cell_i = adj_cells_tree[d] / nb_cols;
+        cell_j = adj_cells_tree[d] % nb_cols;
         if (game_get_square(g, cell_i, cell_j) == TENT) {
           bool is_taken = false;
-          for (uint nb = 0; nb < nb_taken * 2; nb += 2) {
-            if (cell_i == taken_tents[nb] && cell_j == taken_tents[nb + 1]) {
+          for (uint t = 0; t < nb_taken * 2; t += 2) {
+            if (cell_i == taken_tents[t] && cell_j == taken_tents[t + 1]) {
               is_taken = true;
               nb_tents_not_avail++;
               break;
@@ -591,7 +449,6 @@ uint fill_according_to_trees(game g) {
           possible_placement_i = cell_i;
           possible_placement_j = cell_j;
         }
-        ind += 2;
       }
       if (nb_tent_placements == 1) {
         if (game_get_square(g, possible_placement_i, possible_placement_j) ==
@@ -606,241 +463,863 @@ uint fill_according_to_trees(game g) {
         nb_taken++;
         cpt++;
       } else if (nb_tents_avail == 1 && nb_tents_not_avail == 0) {
-        ind = 1;
-        while (adj_cells_tree[ind - 1] < game_nb_rows(g)) {
-          cell_i = adj_cells_tree[ind - 1];
-          cell_j = adj_cells_tree[ind];
+        for (uint d = 0; d < 8; d += 2) {
+          if (adj_cells_tree[d] == NO_CELL) {
+            continue;
+          }
+          cell_i = adj_cells_tree[d] / nb_cols;
+          cell_j = adj_cells_tree[d] % nb_cols;
           if (game_get_square(g, cell_i, cell_j) == TENT &&
-              nb_trees_around_cell(g, cell_i, cell_j) == 1) {
-            uint ind2 = 1;
+              nb_trees_around_cell(g, nb, adj_cells_tree[d]) == 1) {
             taken_tents[nb_taken * 2] = cell_i;
             taken_tents[nb_taken * 2 + 1] = cell_j;
             taken_trees[nb_taken * 2] = trees[i];
             taken_trees[nb_taken * 2 + 1] = trees[i + 1];
             nb_taken++;
             cpt++;
-            while (adj_cells_tree[ind2 - 1] < game_nb_rows(g)) {
-              uint cell_i2 = adj_cells_tree[ind2 - 1];
-              uint cell_j2 = adj_cells_tree[ind2];
+            for (uint d2 = 0; d2 < 8; d2 += 2) {
+              if (adj_cells_tree[d2] == NO_CELL) {
+                continue;
+              }
+              uint cell_i2 = adj_cells_tree[d2] / nb_cols;
+              uint cell_j2 = adj_cells_tree[d2] % nb_cols;
               if (game_get_square(g, cell_i2, cell_j2) == EMPTY &&
-                  nb_trees_around_cell(g, cell_i2, cell_j2) == 1) {
+                  nb_trees_around_cell(g, nb, adj_cells_tree[d2]) == 1) {
                 nb_moves++;
-                // printf("playing grass in %u %u \n", cell_i2, cell_j2);
                 game_play_move(g, cell_i2, cell_j2, GRASS);
               }
-              ind2 += 2;
             }
             break;
           }
-          ind += 2;
         }
       }
-      free(adj_cells_tree);
     }
   }
-  free(taken_tents);
-  free(taken_trees);
-  free(trees);
+  arena_release(nb->scratch, mark);
   return nb_moves;
 }
+
 /**
- * @brief Gives the size of the section that the cell is in (in a given
- *direction)
- * @details Counts the number of cells that are empty around the cell
+ * @brief Looks for a tree that has no tent around it, and a single empty cell
+ *left for it
  * @param g the game
- * @param i row index
- * @param j column index
- * @param vertical the direction of the section
- * @return the total number of moves that have been made
+ * @param nb the neighbour tables of the game
+ * @param p_i receives the row index of the empty cell, which must be a tent
+ * @param p_j receives the column index of the empty cell
+ * @return true if such a tree was found
  * @pre @p g must be a valid pointer toward a game structure.
  **/
-uint size_of_section(cgame g, uint i, uint j, bool vertical) {
-  if (g == NULL) {
-    fprintf(stderr, "Function called on NULL pointer\n");
-    exit(EXIT_FAILURE);
-  }
-  if (vertical) {
-    if ((i == 0 && (nb_empty_cells_above(g, i, j) == game_nb_rows(g) - 1)) ||
-        (i == game_nb_rows(g) - 1 &&
-         nb_empty_cells_below(g, i, j) == game_nb_rows(g) - 1)) {
-      return game_nb_rows(g);
+bool hint_according_to_trees(cgame g, const neighbours *nb, uint *p_i,
+                             uint *p_j) {
+  uint nb_cols = nb->nb_cols;
+  for (uint t = 0; t < nb->nb_trees * 2; t += 2) {
+    const uint *around =
+        nb->around + (nb->trees[t] * nb_cols + nb->trees[t + 1]) * 8;
+    uint nb_tents = 0;
+    uint nb_empty = 0;
+    uint empty_cell = NO_CELL;
+    for (uint d = 0; d < 8; d += 2) {
+      if (around[d] == NO_CELL) {
+        continue;
+      }
+      square s = game_get_square(g, around[d] / nb_cols, around[d] % nb_cols);
+      if (s == TENT) {
+        nb_tents++;
+      } else if (s == EMPTY) {
+        nb_empty++;
+        empty_cell = around[d];
+      }
+    }
+    if (nb_tents == 0 && nb_empty == 1) {
+      *p_i = empty_cell / nb_cols;
+      *p_j = empty_cell % nb_cols;
+      return true;
     }
-    return 1 + nb_empty_cells_above(g, i, j) + nb_empty_cells_below(g, i, j);
   }
-  if ((j == 0 && nb_empty_cells_to_the_left(g, i, j) == game_nb_cols(g) - 1) ||
-      (j == game_nb_cols(g) - 1 &&
-       nb_empty_cells_to_the_right(g, i, j) == game_nb_cols(g) - 1)) {
-    return game_nb_cols(g);
+  return false;
+}
+
+/**
+ * @brief Tells if some tents or grass have been played in a game
+ * @param g the game
+ * @return false if the game only has its trees
+ **/
+bool has_moves(cgame g) {
+  uint nb_cols = game_nb_cols(g);
+  for (uint i = 0; i < game_nb_rows(g); i++) {
+    const unsigned char *row = game_row_squares(g, i);
+    if (scan_count(row, nb_cols, EMPTY) + scan_count(row, nb_cols, TREE) !=
+        nb_cols) {
+      return true;
+    }
   }
-  return 1 + nb_empty_cells_to_the_right(g, i, j) +
-         nb_empty_cells_to_the_left(g, i, j);
+  return false;
 }
 
 /**
- * @brief Gives the number of empty cells above the given cell
+ * @brief Plays the cached solution of the puzzle of a game
+ * @details The solution is only used if it agrees with the tents and grass
+ *that have already been played.
  * @param g the game
- * @param i row index
- * @param j column index
- * @return the number of empty cells above
+ * @param key the key of the puzzle of @p g, or NULL
+ * @return true if the game has been solved
  * @pre @p g must be a valid pointer toward a game structure.
  **/
-uint nb_empty_cells_above(cgame g, uint i, uint j) {
-  uint nb = 0;
-  uint current_i = i;
-  uint cpt = 0;
-  while (current_i != game_nb_rows(g) &&
-         game_get_square(g, current_i, j) == EMPTY && cpt != game_nb_rows(g)) {
-    nb++;
-    if (current_i != 0) {
-      current_i = current_i - 1;
-    } else if (game_is_wrapping(g)) {
-      current_i = game_nb_rows(g) - 1;
-    } else {
-      current_i = game_nb_rows(g);
+bool solve_from_cache(game g, solution_cache_key key) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  unsigned char *solution = (unsigned char *)malloc((size_t)nb_rows * nb_cols);
+  if (solution == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  if (!solution_cache_key_solution(key, g, solution)) {
+    free(solution);
+    return false;
+  }
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      square s = game_get_square(g, i, j);
+      if (s != EMPTY && s != solution[i * nb_cols + j]) {
+        free(solution);
+        return false;
+      }
     }
-    cpt++;
   }
-  if (game_get_square(g, i, j) == EMPTY) {
-    return nb - 1;
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      if (game_get_square(g, i, j) == EMPTY) {
+        game_play_move(g, i, j, solution[i * nb_cols + j]);
+      }
+    }
   }
-  return nb;
+  free(solution);
+  return true;
 }
 
 /**
- * @brief Gives the number of empty cells below the given cell
+ * @brief Gives the time of a monotonic clock
+ * @return the time, in seconds
+ **/
+double now_seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Starts counting what a search spends
+ * @param limits the limits to set
+ * @param opts the options of the solve, or NULL
+ **/
+void limits_init(search_limits *limits, const solve_options *opts) {
+  limits->options = opts;
+  limits->deadline = 0;
+  if (opts != NULL && opts->time_limit > 0) {
+    limits->deadline = now_seconds() + opts->time_limit;
+  }
+  limits->nb_nodes = 0;
+  limits->stopped = SOLVE_FOUND;
+}
+
+/**
+ * @brief Tells if a search has to stop before trying another tent
+ * @param limits the limits of the search
+ * @return true if the search has to stop (limits->stopped then tells why)
+ **/
+bool out_of_budget(search_limits *limits) {
+  const solve_options *opts = limits->options;
+  if (opts == NULL) {
+    return false;
+  }
+#ifdef __GNUC__
+  bool cancelled = __atomic_load_n(&opts->cancelled, __ATOMIC_RELAXED) != 0;
+#else
+  bool cancelled = *(volatile const int *)&opts->cancelled != 0;
+#endif
+  if (cancelled) {
+    limits->stopped = SOLVE_CANCELLED;
+  } else if ((opts->max_nodes != 0 && limits->nb_nodes >= opts->max_nodes) ||
+             (limits->deadline != 0 && now_seconds() > limits->deadline)) {
+    limits->stopped = SOLVE_TIMEOUT;
+  }
+  return limits->stopped != SOLVE_FOUND;
+}
+
+/**
+ * @brief Copies the squares of a game
  * @param g the game
- * @param i row index
- * @param j column index
- * @return the number of empty cells below
- * @pre @p g must be a valid pointer toward a game structure.
+ * @return the squares, in row-major order, to be freed
  **/
-uint nb_empty_cells_below(cgame g, uint i, uint j) {
-  uint nb = 0;
-  uint current_i = i;
-  uint cpt = 0;
-  while (current_i != game_nb_rows(g) &&
-         game_get_square(g, current_i, j) == EMPTY && cpt != game_nb_rows(g)) {
-    nb++;
-    if (current_i != game_nb_rows(g) - 1) {
-      current_i = current_i + 1;
-    } else if (game_is_wrapping(g)) {
-      current_i = 0;
-    } else {
-      current_i = game_nb_rows(g);
-    }
-    cpt++;
+unsigned char *save_squares(cgame g) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  unsigned char *squares = (unsigned char *)malloc((size_t)nb_rows * nb_cols);
+  if (squares == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
   }
-  if (game_get_square(g, i, j) == EMPTY) {
-    return nb - 1;
+  for (uint i = 0; i < nb_rows; i++) {
+    memcpy(squares + i * nb_cols, game_row_squares(g, i), nb_cols);
   }
-  return nb;
+  return squares;
 }
 
 /**
- * @brief Gives the number of empty cells to the left of the given cell
+ * @brief Undoes the moves of a search, until the game has its squares back
  * @param g the game
- * @param i row index
- * @param j column index
- * @return the number of empty cells to the left
- * @pre @p g must be a valid pointer toward a game structure.
+ * @param squares the squares it had before the search (see save_squares)
  **/
-uint nb_empty_cells_to_the_right(cgame g, uint i, uint j) {
-  uint cpt = 0;
-  uint nb = 0;
-  uint current_j = j;
-  while (current_j != game_nb_cols(g) &&
-         game_get_square(g, i, current_j) == EMPTY && cpt != game_nb_cols(g)) {
-    nb++;
-    if (current_j != game_nb_cols(g) - 1) {
-      current_j = current_j + 1;
-    } else if (game_is_wrapping(g)) {
-      current_j = 0;
+void restore_squares(game g, const unsigned char *squares) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  uint i = 0;
+  while (i < nb_rows) {
+    if (memcmp(game_row_squares(g, i), squares + i * nb_cols, nb_cols) != 0) {
+      game_undo(g);
+      i = 0;
     } else {
-      current_j = game_nb_cols(g);
+      i++;
     }
   }
-  if (game_get_square(g, i, j) == EMPTY) {
-    return nb - 1;
-  }
-  return nb;
 }
 
 /**
- * @brief Gives the number of empty cells to the right of the given cell
+ * @brief Tells if a recorded nogood forbids a square
+ * @param store the nogoods
  * @param g the game
- * @param i row index
- * @param j column index
- * @return the number of empty cells to the right
- * @pre @p g must be a valid pointer toward a game structure.
+ * @param cell the cell, as i * nb_cols + j
+ * @param s the square that would be played in the cell
+ * @return true if, with @p s in @p cell, the game would have all of the
+ *squares of a nogood
  **/
-uint nb_empty_cells_to_the_left(cgame g, uint i, uint j) {
-  uint cpt = 0;
-  uint nb = 0;
-  uint current_j = j;
-  while (current_j != game_nb_cols(g) &&
-         game_get_square(g, i, current_j) == EMPTY && cpt != game_nb_cols(g)) {
-    nb++;
-    if (current_j != 0) {
-      current_j = current_j - 1;
-    } else if (game_is_wrapping(g)) {
-      current_j = game_nb_cols(g) - 1;
-    } else {
-      current_j = game_nb_cols(g);
+bool nogood_forbids(const nogood_store *store, cgame g, uint cell, square s) {
+  if (store->nogoods == NULL) {
+    return false;
+  }
+  uint nb_cols = game_nb_cols(g);
+  for (uint entry = store->first[cell]; entry != NO_CELL;) {
+    const nogood *ng = &store->nogoods[entry / MAX_NOGOOD_SIZE];
+    uint p = entry % MAX_NOGOOD_SIZE;
+    entry = ng->next[p];
+    if (ng->squares[p] != s) {
+      continue;
     }
-    cpt++;
+    bool all = true;
+    for (uint q = 0; q < ng->nb_squares && all; q++) {
+      uint other = ng->cells[q];
+      const unsigned char *row = game_row_squares(g, other / nb_cols);
+      all = q == p || row[other % nb_cols] == ng->squares[q];
+    }
+    if (all) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Records a nogood, unless there are already too many of them
+ * @param store the nogoods, that are being recorded
+ * @param cells the cells of the squares
+ * @param squares the squares
+ * @param nb_squares the number of squares, at most MAX_NOGOOD_SIZE
+ **/
+void nogood_add(nogood_store *store, const uint *cells,
+                const unsigned char *squares, uint nb_squares) {
+  if (store->nb_nogoods == MAX_NOGOODS) {
+    return;
   }
-  if (game_get_square(g, i, j) == EMPTY) {
-    return nb - 1;
+  uint k = store->nb_nogoods;
+  nogood *ng = &store->nogoods[k];
+  ng->nb_squares = nb_squares;
+  for (uint p = 0; p < nb_squares; p++) {
+    ng->cells[p] = cells[p];
+    ng->squares[p] = squares[p];
+    ng->next[p] = store->first[cells[p]];
+    store->first[cells[p]] = k * MAX_NOGOOD_SIZE + p;
   }
-  return nb;
+  store->nb_nogoods++;
 }
 
 /**
- * @brief Gives the number of possible tent placements in the row
- * @param g the game
- * @param i row index
- * @return the number of possible tent placements in the row
- * @pre @p g must be a valid pointer toward a game structure.
+ * @brief Starts recording nogoods
+ * @param store the nogoods, none of which is recorded yet
+ * @param a the arena of the recorded nogoods
+ * @param nb_cells the number of cells of the game
  **/
-uint nb_possible_tent_placements_row(cgame g, uint i) {
-  if (g == NULL) {
-    fprintf(stderr, "Function called on NULL pointer\n");
+void nogood_start(nogood_store *store, arena *a, uint nb_cells) {
+  store->nogoods = (nogood *)arena_alloc(a, sizeof(nogood) * MAX_NOGOODS);
+  store->first = (uint *)arena_alloc(a, sizeof(uint) * nb_cells);
+  for (uint cell = 0; cell < nb_cells; cell++) {
+    store->first[cell] = NO_CELL;
+  }
+  store->nb_nogoods = 0;
+}
+
+/**
+ * @brief Forgets the recorded nogoods, once their arena has been released
+ * @param store the nogoods
+ **/
+void nogood_clear(nogood_store *store) {
+  store->nogoods = NULL;
+  store->first = NULL;
+  store->nb_nogoods = 0;
+}
+
+/**
+ * @brief Finds what the placements of the tents of a row or column have in
+ *each of its cells
+ * @details A placement puts exactly @p nb_tents tents in the line, where the
+ *kinds of the cells allow them, and never two tents next to each other. The
+ *placements are never listed: a table of the ways to fill the start of the
+ *line (by number of tents and whether its last cell holds a tent) is built
+ *forwards, another one for the end of the line backwards, and a cell can hold
+ *what joins two entries of them. This takes O(len * nb_tents) steps.
+ * @param kinds the kind of each cell (LINE_NO_TENT, LINE_FREE or LINE_TENT)
+ * @param len the number of cells of the line
+ * @param nb_tents the number of tents of the line
+ * @param a the arena of the tables, which are released before returning
+ * @param placed receives, or-ed with what it holds, the PLACED_NO_TENT and
+ *PLACED_TENT flags of each cell
+ * @return true if there is at least one placement
+ **/
+bool line_placements(const unsigned char *kinds, uint len, uint nb_tents,
+                     arena *a, unsigned char *placed) {
+  if (nb_tents > len) {
+    return false;
+  }
+  // entry (p, c, t) is at p * width + 2 * c + t
+  uint width = 2 * (nb_tents + 1);
+  arena_mark mark = arena_get_mark(a);
+  // forward: the p first cells can hold c tents, the last one holding t
+  unsigned char *head = (unsigned char *)arena_alloc(a, width * (len + 1));
+  // backward: the cells from p on can hold c tents, cell p - 1 holding t
+  unsigned char *tail = (unsigned char *)arena_alloc(a, width * (len + 1));
+  memset(head, 0, width * (len + 1));
+  memset(tail, 0, width * (len + 1));
+  head[0] = 1;
+  for (uint p = 0; p < len; p++) {
+    const unsigned char *from = head + p * width;
+    unsigned char *to = head + (p + 1) * width;
+    for (uint c = 0; c <= nb_tents; c++) {
+      if (from[2 * c] == 0 && from[2 * c + 1] == 0) {
+        continue;
+      }
+      if (kinds[p] != LINE_TENT) {
+        to[2 * c] = 1;
+      }
+      if (kinds[p] != LINE_NO_TENT && from[2 * c] && c < nb_tents) {
+        to[2 * (c + 1) + 1] = 1;
+      }
+    }
+  }
+  tail[len * width] = 1;
+  tail[len * width + 1] = 1;
+  for (uint p = len; p-- > 0;) {
+    const unsigned char *from = tail + (p + 1) * width;
+    unsigned char *to = tail + p * width;
+    for (uint c = 0; c <= nb_tents; c++) {
+      bool no_tent = kinds[p] != LINE_TENT && from[2 * c];
+      bool tent = kinds[p] != LINE_NO_TENT && c > 0 && from[2 * (c - 1) + 1];
+      to[2 * c] = no_tent || tent;
+      to[2 * c + 1] = no_tent;
+    }
+  }
+  bool feasible = tail[2 * nb_tents] != 0;
+  if (feasible) {
+    for (uint p = 0; p < len; p++) {
+      const unsigned char *before = head + p * width;
+      const unsigned char *after = tail + (p + 1) * width;
+      for (uint c = 0; c <= nb_tents; c++) {
+        if (before[2 * c] == 0 && before[2 * c + 1] == 0) {
+          continue;
+        }
+        if (kinds[p] != LINE_TENT && after[2 * (nb_tents - c)]) {
+          placed[p] |= PLACED_NO_TENT;
+        }
+        if (kinds[p] != LINE_NO_TENT && before[2 * c] && c < nb_tents &&
+            after[2 * (nb_tents - c - 1) + 1]) {
+          placed[p] |= PLACED_TENT;
+        }
+      }
+    }
+  }
+  arena_release(a, mark);
+  return feasible;
+}
+
+/**
+ * @brief Tells if a state of game_solve_partial is better than another one
+ * @details The fewer cells a state had to leave empty the better, and then
+ * the fewer empty cells it has the better.
+ * @param a the first state
+ * @param b the second state
+ * @return true if @p a is strictly better than @p b
+ **/
+bool partial_node_better(const partial_node *a, const partial_node *b) {
+  if (a->nb_skipped != b->nb_skipped) {
+    return a->nb_skipped < b->nb_skipped;
+  }
+  return a->nb_empty < b->nb_empty;
+}
+
+/**
+ * @brief Adds a state to the queue of game_solve_partial
+ * @details When the queue is full, its worst state is dropped (which may be
+ * the new one).
+ * @param q the queue
+ * @param node the state, whose reference is taken over by the queue
+ **/
+void partial_queue_push(partial_queue *q, partial_node node) {
+  if (q->size < q->capacity) {
+    q->nodes[q->size] = node;
+    q->size++;
+    return;
+  }
+  uint worst = 0;
+  for (uint k = 1; k < q->size; k++) {
+    if (partial_node_better(&q->nodes[worst], &q->nodes[k])) {
+      worst = k;
+    }
+  }
+  if (!partial_node_better(&node, &q->nodes[worst])) {
+    game_state_delete(node.state);
+    return;
+  }
+  game_state_delete(q->nodes[worst].state);
+  q->nodes[worst] = node;
+}
+
+/**
+ * @brief Takes the best state out of the queue of game_solve_partial
+ * @details Among equally good states, the last one added comes first, so
+ * that the search goes deep before going wide.
+ * @param q the queue
+ * @param p_node receives the state, whose reference is given to the caller
+ * @return false if the queue is empty
+ **/
+bool partial_queue_pop(partial_queue *q, partial_node *p_node) {
+  if (q->size == 0) {
+    return false;
+  }
+  uint best = q->size - 1;
+  for (uint k = q->size - 1; k-- > 0;) {
+    if (partial_node_better(&q->nodes[k], &q->nodes[best])) {
+      best = k;
+    }
+  }
+  *p_node = q->nodes[best];
+  q->size--;
+  q->nodes[best] = q->nodes[q->size];
+  return true;
+}
+
+/* One solver per combination of the wrapping and diagadj options */
+#define SOLVER_WRAPPING false
+#define SOLVER_DIAGADJ false
+#define SOLVER_FN(name) name##_plain
+#include "game_solver_variant.h"
+
+#define SOLVER_WRAPPING true
+#define SOLVER_DIAGADJ false
+#define SOLVER_FN(name) name##_wrapping
+#include "game_solver_variant.h"
+
+#define SOLVER_WRAPPING false
+#define SOLVER_DIAGADJ true
+#define SOLVER_FN(name) name##_diagadj
+#include "game_solver_variant.h"
+
+#define SOLVER_WRAPPING true
+#define SOLVER_DIAGADJ true
+#define SOLVER_FN(name) name##_wrapping_diagadj
+#include "game_solver_variant.h"
+
+bool game_solve(game g) {
+  return game_solve_ext(g, NULL) == SOLVE_FOUND;
+}
+
+solve_status game_solve_ext(game g, const solve_options *opts) {
+  test_pointer(g);
+  search_limits limits;
+  limits_init(&limits, opts);
+  if (out_of_budget(&limits)) {
+    return limits.stopped;
+  }
+  // the canonical puzzle is made once, for the lookups and the record
+  solution_cache_key key = solution_cache_key_new(g);
+  // a puzzle without solution has none whatever has been played
+  if (solution_cache_key_nb_solutions(key) == 0) {
+    solution_cache_key_delete(key);
+    return SOLVE_NONE;
+  }
+  if (solve_from_cache(g, key)) {
+    solution_cache_key_delete(key);
+    return SOLVE_FOUND;
+  }
+  bool pristine = !has_moves(g);
+  unsigned char *squares = save_squares(g);
+  neighbours *nb = neighbours_new(g);
+  bool solved;
+  // the options are looked at once, here, to pick the right solver
+  if (game_is_wrapping(g)) {
+    if (game_is_diagadj(g)) {
+      solved = solve_wrapping_diagadj(g, nb, &limits);
+    } else {
+      solved = solve_wrapping(g, nb, &limits);
+    }
+  } else {
+    if (game_is_diagadj(g)) {
+      solved = solve_diagadj(g, nb, &limits);
+    } else {
+      solved = solve_plain(g, nb, &limits);
+    }
+  }
+  neighbours_delete(nb);
+  if (!solved) {
+    restore_squares(g, squares);
+  }
+  free(squares);
+  if (limits.stopped == SOLVE_FOUND && pristine) {
+    solution_cache_key_add(key, solved ? g : NULL,
+                           solved ? SOLUTION_CACHE_UNKNOWN : 0);
+  }
+  solution_cache_key_delete(key);
+  if (limits.stopped != SOLVE_FOUND) {
+    return limits.stopped;
+  }
+  return solved ? SOLVE_FOUND : SOLVE_NONE;
+}
+
+uint game_nb_solutions(game g) {
+  uint nb_sols;
+  game_nb_solutions_ext(g, NULL, &nb_sols);
+  return nb_sols;
+}
+
+solve_status game_nb_solutions_ext(game g, const solve_options *opts,
+                                   uint *p_nb_solutions) {
+  test_pointer(g);
+  if (p_nb_solutions == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
     exit(EXIT_FAILURE);
   }
-  uint nb = 0;
-  bool is_prev_tent = false;
-  for (uint j = 0; j < game_nb_cols(g); j++) {
-    if (game_get_square(g, i, j) == EMPTY && !is_prev_tent) {
-      nb++;
-      is_prev_tent = true;
+  *p_nb_solutions = 0;
+  search_limits limits;
+  limits_init(&limits, opts);
+  if (out_of_budget(&limits)) {
+    return limits.stopped;
+  }
+  // the number of solutions of the puzzle is cached, not the one of a game
+  // where some moves have been played
+  bool pristine = !has_moves(g);
+  solution_cache_key key = pristine ? solution_cache_key_new(g) : NULL;
+  uint cached = solution_cache_key_nb_solutions(key);
+  if (cached != SOLUTION_CACHE_UNKNOWN) {
+    solution_cache_key_delete(key);
+    *p_nb_solutions = cached;
+    return cached == 0 ? SOLVE_NONE : SOLVE_FOUND;
+  }
+  unsigned char *squares = save_squares(g);
+  neighbours *nb = neighbours_new(g);
+  // the count depends on the states the search goes through (see solve_rec)
+  nb->whole_lines = false;
+  uint nb_sols;
+  if (game_is_wrapping(g)) {
+    if (game_is_diagadj(g)) {
+      nb_sols = nb_solutions_wrapping_diagadj(g, nb, &limits);
+    } else {
+      nb_sols = nb_solutions_wrapping(g, nb, &limits);
+    }
+  } else {
+    if (game_is_diagadj(g)) {
+      nb_sols = nb_solutions_diagadj(g, nb, &limits);
     } else {
-      is_prev_tent = false;
+      nb_sols = nb_solutions_plain(g, nb, &limits);
     }
   }
-  return nb;
+  neighbours_delete(nb);
+  *p_nb_solutions = nb_sols;
+  if (limits.stopped != SOLVE_FOUND) {
+    restore_squares(g, squares);
+    free(squares);
+    solution_cache_key_delete(key);
+    return limits.stopped;
+  }
+  free(squares);
+  solution_cache_key_add(key, NULL, nb_sols);
+  solution_cache_key_delete(key);
+  return nb_sols == 0 ? SOLVE_NONE : SOLVE_FOUND;
+}
+
+solve_status game_solve_partial(game g, const solve_options *opts) {
+  test_pointer(g);
+  search_limits limits;
+  limits_init(&limits, opts);
+  if (out_of_budget(&limits)) {
+    return limits.stopped;
+  }
+  solution_cache_key key = solution_cache_key_new(g);
+  bool cached = solve_from_cache(g, key);
+  solution_cache_key_delete(key);
+  if (cached) {
+    return SOLVE_FOUND;
+  }
+  neighbours *nb = neighbours_new(g);
+  bool solved;
+  game_state *best;
+  if (game_is_wrapping(g)) {
+    if (game_is_diagadj(g)) {
+      best = solve_partial_wrapping_diagadj(g, nb, &limits, &solved);
+    } else {
+      best = solve_partial_wrapping(g, nb, &limits, &solved);
+    }
+  } else {
+    if (game_is_diagadj(g)) {
+      best = solve_partial_diagadj(g, nb, &limits, &solved);
+    } else {
+      best = solve_partial_plain(g, nb, &limits, &solved);
+    }
+  }
+  neighbours_delete(nb);
+  // the best state only adds squares to the ones of g
+  game_play_solution(g, game_state_game(best));
+  game_state_delete(best);
+  if (solved) {
+    return SOLVE_FOUND;
+  }
+  return limits.stopped != SOLVE_FOUND ? limits.stopped : SOLVE_NONE;
+}
+
+void solve_cancel(solve_options *opts) {
+  if (opts == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
+    exit(EXIT_FAILURE);
+  }
+#ifdef __GNUC__
+  __atomic_store_n(&opts->cancelled, 1, __ATOMIC_RELAXED);
+#else
+  *(volatile int *)&opts->cancelled = 1;
+#endif
+}
+
+hint_rule game_hint(cgame g, uint *p_i, uint *p_j, square *p_s) {
+  test_pointer(g);
+  if (p_i == NULL || p_j == NULL || p_s == NULL) {
+    fprintf(stderr, "Function called on NULL pointer!\n");
+    exit(EXIT_FAILURE);
+  }
+  neighbours *nb = neighbours_new(g);
+  hint_rule rule;
+  if (game_is_wrapping(g)) {
+    if (game_is_diagadj(g)) {
+      rule = hint_wrapping_diagadj(g, nb, p_i, p_j, p_s);
+    } else {
+      rule = hint_wrapping(g, nb, p_i, p_j, p_s);
+    }
+  } else {
+    if (game_is_diagadj(g)) {
+      rule = hint_diagadj(g, nb, p_i, p_j, p_s);
+    } else {
+      rule = hint_plain(g, nb, p_i, p_j, p_s);
+    }
+  }
+  neighbours_delete(nb);
+  return rule;
 }
 
 /**
- * @brief Gives the number of possible tent placements in the column
+ * @brief Gives the cell of a game that a symmetry moves to a given cell
  * @param g the game
- * @param j column index
- * @return the number of possible tent placements in the column
- * @pre @p g must be a valid pointer toward a game structure.
+ * @param sym the symmetry
+ * @param i row index in the transformed game
+ * @param j column index in the transformed game
+ * @param p_i receives the row index in @p g
+ * @param p_j receives the column index in @p g
  **/
-uint nb_possible_tent_placements_col(cgame g, uint j) {
-  if (g == NULL) {
-    fprintf(stderr, "Function called on NULL pointer\n");
-    exit(EXIT_FAILURE);
+void original_cell(cgame g, const game_symmetry *sym, uint i, uint j,
+                   uint *p_i, uint *p_j) {
+  uint nb_rows = sym->transpose ? game_nb_cols(g) : game_nb_rows(g);
+  uint nb_cols = sym->transpose ? game_nb_rows(g) : game_nb_cols(g);
+  i = (i + nb_rows - sym->shift_i) % nb_rows;
+  j = (j + nb_cols - sym->shift_j) % nb_cols;
+  if (sym->flip_rows) {
+    i = nb_rows - 1 - i;
   }
-  uint nb = 0;
-  bool is_prev_tent = false;
-  for (uint i = 0; i < game_nb_rows(g); i++) {
-    if (game_get_square(g, i, j) == EMPTY && !is_prev_tent) {
-      nb++;
-      is_prev_tent = true;
-    } else {
-      is_prev_tent = false;
+  if (sym->flip_cols) {
+    j = nb_cols - 1 - j;
+  }
+  *p_i = sym->transpose ? j : i;
+  *p_j = sym->transpose ? i : j;
+}
+
+/**
+ * @brief Gives a value of the puzzle of a transformed game
+ * @details The puzzle is read as the sequence of its number of rows, its
+ * expected numbers of tents in the rows then in the columns, and a 1 for each
+ * tree and 0 for each other square, in row-major order. The values are
+ * computed from @p g, the transformed game is never built.
+ * @param g the game
+ * @param sym the symmetry
+ * @param k index of the value
+ * @return the value
+ **/
+uint puzzle_value(cgame g, const game_symmetry *sym, uint k) {
+  uint nb_rows = sym->transpose ? game_nb_cols(g) : game_nb_rows(g);
+  uint nb_cols = sym->transpose ? game_nb_rows(g) : game_nb_cols(g);
+  uint i, j;
+  if (k == 0) {
+    return nb_rows;
+  }
+  k--;
+  if (k < nb_rows) {
+    original_cell(g, sym, k, 0, &i, &j);
+    return sym->transpose ? game_get_expected_nb_tents_col(g, j)
+                          : game_get_expected_nb_tents_row(g, i);
+  }
+  k -= nb_rows;
+  if (k < nb_cols) {
+    original_cell(g, sym, 0, k, &i, &j);
+    return sym->transpose ? game_get_expected_nb_tents_row(g, i)
+                          : game_get_expected_nb_tents_col(g, j);
+  }
+  k -= nb_cols;
+  original_cell(g, sym, k / nb_cols, k % nb_cols, &i, &j);
+  return game_row_squares(g, i)[j] == TREE;
+}
+
+/**
+ * @brief Compares the puzzles that two symmetries give
+ * @details The values are compared one after the other, so two different
+ * puzzles are usually told apart after a few of them.
+ * @param g the game
+ * @param a the first symmetry
+ * @param b the second symmetry
+ * @return a negative number if the puzzle given by @p a comes first, a
+ * positive one if it comes last, and 0 if they are the same
+ **/
+int compare_symmetries(cgame g, const game_symmetry *a,
+                       const game_symmetry *b) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  uint nb_values = 1 + nb_rows + nb_cols + nb_rows * nb_cols;
+  for (uint k = 0; k < nb_values; k++) {
+    uint value_a = puzzle_value(g, a, k);
+    uint value_b = puzzle_value(g, b, k);
+    if (value_a != value_b) {
+      return value_a < value_b ? -1 : 1;
     }
   }
-  return nb;
+  return 0;
+}
+
+void game_symmetry_cell(cgame g, game_symmetry sym, uint i, uint j, uint *p_i,
+                        uint *p_j) {
+  test_pointer(g);
+  test_i_value(g, i);
+  test_j_value(g, j);
+  if (sym.transpose) {
+    uint tmp = i;
+    i = j;
+    j = tmp;
+  }
+  uint nb_rows = sym.transpose ? game_nb_cols(g) : game_nb_rows(g);
+  uint nb_cols = sym.transpose ? game_nb_rows(g) : game_nb_cols(g);
+  if (sym.flip_rows) {
+    i = nb_rows - 1 - i;
+  }
+  if (sym.flip_cols) {
+    j = nb_cols - 1 - j;
+  }
+  *p_i = (i + sym.shift_i) % nb_rows;
+  *p_j = (j + sym.shift_j) % nb_cols;
+}
+
+game game_transform(cgame g, game_symmetry sym) {
+  test_pointer(g);
+  uint nb_rows = sym.transpose ? game_nb_cols(g) : game_nb_rows(g);
+  uint nb_cols = sym.transpose ? game_nb_rows(g) : game_nb_cols(g);
+  game t = game_new_empty_ext(nb_rows, nb_cols, game_is_wrapping(g),
+                              game_is_diagadj(g));
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      uint orig_i, orig_j;
+      original_cell(g, &sym, i, j, &orig_i, &orig_j);
+      game_set_square(t, i, j, game_get_square(g, orig_i, orig_j));
+    }
+  }
+  for (uint i = 0; i < nb_rows; i++) {
+    game_set_expected_nb_tents_row(t, i, puzzle_value(g, &sym, 1 + i));
+  }
+  for (uint j = 0; j < nb_cols; j++) {
+    game_set_expected_nb_tents_col(t, j,
+                                   puzzle_value(g, &sym, 1 + nb_rows + j));
+  }
+  return t;
+}
+
+game_symmetry game_canonical_symmetry(cgame g) {
+  test_pointer(g);
+  game_symmetry best = {false, false, false, 0, 0};
+  for (uint k = 0; k < 8; k++) {
+    game_symmetry sym = {(k & 4) != 0, (k & 2) != 0, (k & 1) != 0, 0, 0};
+    uint nb_rows = sym.transpose ? game_nb_cols(g) : game_nb_rows(g);
+    uint nb_cols = sym.transpose ? game_nb_rows(g) : game_nb_cols(g);
+    // a wrapping grid looks the same from any of its cells
+    uint nb_shifts_i = game_is_wrapping(g) ? nb_rows : 1;
+    uint nb_shifts_j = game_is_wrapping(g) ? nb_cols : 1;
+    for (sym.shift_i = 0; sym.shift_i < nb_shifts_i; sym.shift_i++) {
+      for (sym.shift_j = 0; sym.shift_j < nb_shifts_j; sym.shift_j++) {
+        if (compare_symmetries(g, &sym, &best) < 0) {
+          best = sym;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+uint64_t game_canonical_hash(cgame g) {
+  test_pointer(g);
+  game_symmetry sym = game_canonical_symmetry(g);
+  // the canonical puzzle is read value by value (see puzzle_value)
+  uint nb_clues = game_nb_rows(g) + game_nb_cols(g);
+  uint nb_squares = game_nb_rows(g) * game_nb_cols(g);
+  uint32_t *clues = (uint32_t *)malloc(sizeof(uint32_t) * nb_clues);
+  unsigned char *squares = (unsigned char *)malloc(nb_squares);
+  if (clues == NULL || squares == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  for (uint k = 0; k < nb_clues; k++) {
+    clues[k] = puzzle_value(g, &sym, 1 + k);
+  }
+  for (uint k = 0; k < nb_squares; k++) {
+    squares[k] = puzzle_value(g, &sym, 1 + nb_clues + k) ? TREE : EMPTY;
+  }
+  uint nb_rows = puzzle_value(g, &sym, 0);
+  uint64_t hash =
+      puzzle_hash(nb_rows, nb_clues - nb_rows, game_is_wrapping(g),
+                  game_is_diagadj(g), clues, squares);
+  free(clues);
+  free(squares);
+  return hash;
+}
+
+uint64_t puzzle_hash(uint nb_rows, uint nb_cols, bool wrapping, bool diagadj,
+                     const uint32_t *clues, const unsigned char *squares) {
+  // FNV-1a, on the size, the options and the values of the puzzle
+  uint64_t hash = 14695981039346656037ULL;
+  uint header[] = {nb_rows, nb_cols, wrapping, diagadj};
+  for (uint k = 0; k < 4; k++) {
+    hash = (hash ^ header[k]) * 1099511628211ULL;
+  }
+  for (uint k = 0; k < nb_rows + nb_cols; k++) {
+    hash = (hash ^ clues[k]) * 1099511628211ULL;
+  }
+  for (size_t k = 0; k < (size_t)nb_rows * nb_cols; k++) {
+    hash = (hash ^ (squares[k] == TREE)) * 1099511628211ULL;
+  }
+  return hash;
 }
@@ -0,0 +1,125 @@
+#include "glyph_atlas.h"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdlib.h>
+#include "graphic_mode.h"
+
+enum {
+  NB_GLYPHS = 128 /**< only the ASCII characters have a glyph */
+};
+
+struct glyph_atlas_s {
+  SDL_Texture *texture;       /**< all of the glyphs, on a single line */
+  int height;                 /**< height of the glyphs in the texture */
+  SDL_Rect glyphs[NB_GLYPHS]; /**< place of each glyph, empty if missing */
+};
+
+// Declaration of the functions that aren't given in the .h files
+static int text_width(const glyph_atlas *a, const char *text);
+
+/**
+ * @brief Gives the width of a text in the texture of an atlas
+ * @param a the atlas
+ * @param text the text
+ * @return the sum of the widths of its glyphs
+ **/
+int text_width(const glyph_atlas *a, const char *text) {
+  int width = 0;
+  for (const char *c = text; *c != '\0'; c++) {
+    unsigned char k = (unsigned char)*c;
+    if (k < NB_GLYPHS) {
+      width += a->glyphs[k].w;
+    }
+  }
+  return width;
+}
+
+glyph_atlas *glyph_atlas_new(SDL_Renderer *ren, const char *font_file,
+                             int font_size, int style, SDL_Color color,
+                             const char *chars) {
+  glyph_atlas *a = (glyph_atlas *)calloc(1, sizeof(glyph_atlas));
+  if (a == NULL) ERROR("Not enough memory!\n");
+  TTF_Font *font = TTF_OpenFont(font_file, font_size);
+  if (!font) ERROR("TTF_OpenFont: %s\n", font_file);
+  TTF_SetFontStyle(font, style);
+  a->height = TTF_FontHeight(font);
+
+  /* place the glyphs one after the other */
+  int width = 0;
+  char glyph[2] = {'\0', '\0'};
+  for (const char *c = chars; *c != '\0'; c++) {
+    unsigned char k = (unsigned char)*c;
+    glyph[0] = *c;
+    int w, h;
+    if (k >= NB_GLYPHS || a->glyphs[k].w > 0 ||
+        TTF_SizeText(font, glyph, &w, &h) != 0) {
+      continue;
+    }
+    a->glyphs[k].x = width;
+    a->glyphs[k].y = 0;
+    a->glyphs[k].w = w;
+    a->glyphs[k].h = a->height;
+    width += w;
+  }
+
+  /* render them in a surface, then in the texture */
+  SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(
+      0, width > 0 ? width : 1, a->height, 32, SDL_PIXELFORMAT_RGBA32);
+  if (!atlas) ERROR("SDL_CreateRGBSurfaceWithFormat: %s\n", SDL_GetError());
+  for (uint k = 1; k < NB_GLYPHS; k++) {
+    if (a->glyphs[k].w == 0) {
+      continue;
+    }
+    glyph[0] = (char)k;
+    SDL_Surface *surf = TTF_RenderText_Blended(font, glyph, color);
+    if (surf) {
+      // the alpha of the glyph is copied, not blended with the empty atlas
+      SDL_SetSurfaceBlendMode(surf, SDL_BLENDMODE_NONE);
+      SDL_Rect dst = a->glyphs[k];
+      SDL_BlitSurface(surf, NULL, atlas, &dst);
+      SDL_FreeSurface(surf);
+    }
+  }
+  a->texture = SDL_CreateTextureFromSurface(ren, atlas);
+  if (!a->texture) ERROR("SDL_CreateTextureFromSurface: %s\n", SDL_GetError());
+  SDL_SetTextureBlendMode(a->texture, SDL_BLENDMODE_BLEND);
+  SDL_FreeSurface(atlas);
+  TTF_CloseFont(font);
+  return a;
+}
+
+float glyph_atlas_ratio(const glyph_atlas *a, const char *text) {
+  if (a->height == 0) {
+    return 0;
+  }
+  return (float)text_width(a, text) / a->height;
+}
+
+void glyph_atlas_draw(SDL_Renderer *ren, const glyph_atlas *a,
+                      const char *text, const SDL_Rect *rect) {
+  int width = text_width(a, text);
+  if (width == 0) {
+    return;
+  }
+  // each glyph gets its share of the width of the rectangle
+  SDL_Rect dst = *rect;
+  int pos = 0;
+  for (const char *c = text; *c != '\0'; c++) {
+    unsigned char k = (unsigned char)*c;
+    if (k >= NB_GLYPHS || a->glyphs[k].w == 0) {
+      continue;
+    }
+    dst.x = rect->x + (int)((long)pos * rect->w / width);
+    pos += a->glyphs[k].w;
+    dst.w = rect->x + (int)((long)pos * rect->w / width) - dst.x;
+    SDL_RenderCopy(ren, a->texture, &a->glyphs[k], &dst);
+  }
+}
+
+void glyph_atlas_delete(glyph_atlas *a) {
+  if (a == NULL) {
+    return;
+  }
+  SDL_DestroyTexture(a->texture);
+  free(a);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file glyph_atlas.h
+ * @brief Glyph atlas used to draw text with SDL.
+ * @details The glyphs of a font are rendered once into a single texture, and
+ * a text is then drawn by copying the rectangle of each of its characters, so
+ * no font has to be opened nor any texture created while the game is running.
+ *
+ **/
+
+#ifndef __GLYPH_ATLAS_H__
+#define __GLYPH_ATLAS_H__
+#include <SDL.h>
+
+/**
+ * @brief The glyph atlas, see @ref glyph_atlas_new.
+ **/
+typedef struct glyph_atlas_s glyph_atlas;
+
+/**
+ * @brief Renders the glyphs of some characters in a font into an atlas
+ * @param ren the renderer the atlas will be drawn with
+ * @param font_file the TTF font file
+ * @param font_size the size of the glyphs in the atlas (they are scaled when
+ * they are drawn)
+ * @param style the font style, TTF_STYLE_NORMAL or TTF_STYLE_BOLD
+ * @param color the color of the glyphs
+ * @param chars the characters to render, only ASCII characters can be given
+ * @return the atlas
+ **/
+glyph_atlas *glyph_atlas_new(SDL_Renderer *ren, const char *font_file,
+                             int font_size, int style, SDL_Color color,
+                             const char *chars);
+
+/**
+ * @brief Gives the ratio between the width and the height of a text
+ * @param a the atlas
+ * @param text the text, characters missing from the atlas are skipped
+ * @return the width of @p text divided by its height
+ **/
+float glyph_atlas_ratio(const glyph_atlas *a, const char *text);
+
+/**
+ * @brief Draws a text, stretched so that it fills a rectangle
+ * @param ren the renderer
+ * @param a the atlas
+ * @param text the text, characters missing from the atlas are skipped
+ * @param rect where to draw the text
+ **/
+void glyph_atlas_draw(SDL_Renderer *ren, const glyph_atlas *a,
+                      const char *text, const SDL_Rect *rect);
+
+/**
+ * @brief Deletes an atlas and its texture
+ * @param a the atlas
+ **/
+void glyph_atlas_delete(glyph_atlas *a);
+
+#endif  // __GLYPH_ATLAS_H__
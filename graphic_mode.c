@@ -4,16 +4,20 @@
 #include <SDL_ttf.h>    // required to use TTF fonts
 #include <dirent.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include "dlist.h"
+#include <string.h>
+#include "extra_functions.h"
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
 #include "game_tools.h"
+#include "glyph_atlas.h"
+#include "level_pack.h"
+#include "solution_cache.h"
 
-#define MAX_GAME_SIZE 20
 /* home screen */
 #define HOME_SCREEN "images/home_screen.png"
 #define HOME_SCREEN_VERT "images/home_screen_small.png"
@@ -48,10 +52,14 @@
 #define LEVEL_SIZE 50
 #define FONT_RATIO 0.7  // ratio of font size to cell size
 #define BUTTON_SIZE 30
-#define FONT_SIZE 16
+#define ATLAS_FONT_SIZE 64  // size of the glyphs in the atlases
+#define ATLAS_DIGITS "0123456789"
+#define ATLAS_CHARS " .:0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 #define TEXT_COLOR \
   { 0, 0, 0, 255 }
 #define ABOVE_GRID_RATIO 0.2
+#define ZOOM_STEP 1.25  // zoom factor of a mouse wheel step or a key press
+#define PINCH_SPEED 3   // zoom factor of a pinch, per unit of finger distance
 #define LEFT_FROM_GRID_RATIO 0.03
 
 /* game_over and end screens */
@@ -64,15 +72,30 @@
 #define RESTART_GAMEOVER "buttons/restart_game_over.png"
 #define QUIT_GAMEOVER "buttons/quit_button.png"
 
+#define NB_LAZY_TEXTURES 26 /* textures loaded after the home screen */
+
 #define BUTTON_WIDTH 1 / 8    // button width according to window width
 #define BUTTON_HEIGHT 1 / 16  // button height according to window width
 
 /* **************************************************************** */
-static void create_tents_text(SDL_Window *win, SDL_Renderer *ren, Env *env);
-static void create_level_text(SDL_Window *win, SDL_Renderer *ren, Env *env);
-static bool mouse_is_in_grid(Env *env, int x, int y);
+static int solve_in_background(void *data);
+static void start_solving(Env *env);
+static void cancel_solving(Env *env);
+static void finish_solving(Env *env);
+static bool cell_at(Env *env, int x, int y, uint *row, uint *col);
+static void level_changed(Env *env);
+static void go_to_level(Env *env, uint level);
+static void update_view(Env *env);
+static void zoom_view(Env *env, float factor, int x, int y);
+static void pan_view(Env *env, int dx, int dy);
+static void visible_cells(Env *env, uint *first_row, uint *end_row,
+                          uint *first_col, uint *end_col);
+static int decode_lazy_textures(void *data);
+static void load_lazy_textures(SDL_Renderer *ren, Env *env);
 static void render_home(SDL_Window *win, SDL_Renderer *ren, Env *env);
 static void render_help(SDL_Window *win, SDL_Renderer *ren, Env *env);
+static void render_static_layer(SDL_Renderer *ren, Env *env, int w, int h);
+static bool update_static_layer(SDL_Renderer *ren, Env *env, int w, int h);
 static void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env);
 static void render_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env);
 static void render_end(SDL_Window *win, SDL_Renderer *ren, Env *env);
@@ -95,6 +118,22 @@ typedef enum {
   END = 4        /* end screen */
 } screen;
 
+/* states of a solve running in the background */
+enum { JOB_RUNNING, JOB_DONE, JOB_CANCELLED };
+
+#define SOLVE_TIME_LIMIT 60 /* s, the solve button gives up after this */
+#define PARTIAL_TIME_LIMIT 5 /* s, then spent solving as much as possible */
+
+/* a solve running in the background, on a copy of the game */
+typedef struct {
+  game g;
+  solve_status status;
+  bool partial;          /* true if g is only solved in part */
+  solve_options options; /* cancelled from the main thread */
+  Uint32 event;          /* event pushed when the solve is over */
+  SDL_atomic_t state;
+} solve_job;
+
 struct Env_t {
   screen current_screen;
   screen previous_screen;
@@ -127,15 +166,21 @@ struct Env_t {
   SDL_Texture *home_button;
   SDL_Texture *help_button_j;
   int side_button_size;
-  SDL_Texture *current_level_text;
-  float level_ratio;
-  SDL_Texture **text;
-  SDL_Texture *wrapping_text;
-  SDL_Texture *diagadj_text;
-  float wrap_diag_ratio;
+  glyph_atlas *level_glyphs;
+  glyph_atlas *label_glyphs; /* wrapping and diagadj texts */
+  glyph_atlas *tents_glyphs; /* numbers of tents */
+  SDL_Texture *static_layer; /* background, trees, grid lines and numbers */
+  int static_layer_w, static_layer_h;
+  bool static_layer_up_to_date;
   int grid_beginning_x;
   int grid_beginning_y;
-  int cell_size;
+  int cell_size;      /* size of a cell when the whole grid is shown */
+  float zoom;         /* 1 when the whole grid is shown */
+  int pan_x, pan_y;   /* pixels of the zoomed grid scrolled out of view */
+  int view_cell_size; /* size of a cell once zoomed */
+  SDL_Rect view;      /* part of the window where the grid is shown */
+  bool gesture_active;
+  int gesture_x, gesture_y; /* center of the last pinch gesture */
   bool switch_button;
   SDL_Texture *switch_1;
   SDL_Texture *switch_2;
@@ -147,31 +192,82 @@ struct Env_t {
   SDL_Texture *previous_level_button;
   SDL_Texture *restart_game_over_button;
   SDL_Texture *quit_button;
-  DList games;
-  uint max_game_rows_reached, max_game_cols_reached;
+  level_pack *levels; /* level k is the game k - 1 of the pack */
   game g;
+  bool dirty; /* true if the window must be redrawn */
+  bool show_hint; /* true if the next deduction is shown on each frame */
+  solve_job *solving; /* solve running in the background, or NULL */
+  Uint32 solving_since;
+  Uint32 solve_event; /* pushed when a solve is over */
+  SDL_Thread *decoding_thread;
+  SDL_Surface *lazy_surfaces[NB_LAZY_TEXTURES];
+  bool lazy_textures_loaded;
 };
 
-#ifdef __ANDROID__
-static void copy_asset(char *src, char *dst) {
-  SDL_RWops *file = SDL_RWFromFile(src, "r");
-  if (!file) ERROR("[ERROR] SDL_RWFromFile: %s\n", src);
-  int size = SDL_RWsize(file);
-  PRINT("copy file %s (%d bytes) into %s\n", src, size, dst);
-  char *buf = (char *)malloc(size + 1);
-  if (!buf) ERROR("[ERROR] malloc\n");
-  int r = SDL_RWread(file, buf, 1, size);
-  PRINT("read %d\n", r);
-  if (r != size) ERROR("[ERROR] fail to read all file (%d bytes)\n", r);
-  FILE *out = fopen(dst, "w+");
-  if (!out) ERROR("[ERROR] fail to create file %s\n", dst);
-  int w = fwrite(buf, 1, r, out);
-  if (r != w) ERROR("[ERROR] fail to write all file (%d bytes)\n", w);
-  fclose(out);
-  SDL_RWclose(file);
-  free(buf);
+/* textures that aren't needed by the home screen: their images are decoded by
+ * a thread started in init(), and the textures are created the first time
+ * another screen is rendered */
+static const struct {
+  const char *file;
+  size_t field; /* offset of the texture in Env */
+} lazy_textures[NB_LAZY_TEXTURES] = {
+    {HELP_SCREEN, offsetof(struct Env_t, help_screen)},
+    {HELP_SCREEN_VERT, offsetof(struct Env_t, help_screen_vert)},
+    {BACK_BUTTON, offsetof(struct Env_t, back_button)},
+    {HOME_BUTTON, offsetof(struct Env_t, home_button)},
+    {HELP_BUTTON_J, offsetof(struct Env_t, help_button_j)},
+    {PALM_TREE, offsetof(struct Env_t, tree)},
+    {WATER, offsetof(struct Env_t, water)},
+    {RAFT, offsetof(struct Env_t, raft)},
+    {L_WATER, offsetof(struct Env_t, losing_water)},
+    {L_RAFT, offsetof(struct Env_t, losing_raft)},
+    {GAME_SCREEN, offsetof(struct Env_t, game_screen)},
+    {GAME_SCREEN_VERT, offsetof(struct Env_t, game_screen_vert)},
+    {SOLVE, offsetof(struct Env_t, solve)},
+    {RESTART, offsetof(struct Env_t, restart)},
+    {UNDO, offsetof(struct Env_t, undo)},
+    {REDO, offsetof(struct Env_t, redo)},
+    {GAME_OVER_SCREEN, offsetof(struct Env_t, game_over_screen)},
+    {GAME_OVER_SCREEN_VERT, offsetof(struct Env_t, game_over_screen_vert)},
+    {END_SCREEN, offsetof(struct Env_t, end_screen)},
+    {END_SCREEN_VERT, offsetof(struct Env_t, end_screen_vert)},
+    {NEXT_LEVEL, offsetof(struct Env_t, next_level_button)},
+    {PREVIOUS_LEVEL, offsetof(struct Env_t, previous_level_button)},
+    {RESTART_GAMEOVER, offsetof(struct Env_t, restart_game_over_button)},
+    {QUIT_GAMEOVER, offsetof(struct Env_t, quit_button)},
+    {SWITCH_1, offsetof(struct Env_t, switch_1)},
+    {SWITCH_2, offsetof(struct Env_t, switch_2)}};
+
+/* decodes the images of the lazy textures (run by the decoding thread) */
+int decode_lazy_textures(void *data) {
+  Env *env = (Env *)data;
+  for (uint k = 0; k < NB_LAZY_TEXTURES; k++) {
+    env->lazy_surfaces[k] = IMG_Load(lazy_textures[k].file);
+  }
+  return 0;
 }
-#endif
+
+/* waits for the decoding thread if needed, and creates the lazy textures */
+void load_lazy_textures(SDL_Renderer *ren, Env *env) {
+  if (env->lazy_textures_loaded) {
+    return;
+  }
+  SDL_WaitThread(env->decoding_thread, NULL);
+  env->decoding_thread = NULL;
+  for (uint k = 0; k < NB_LAZY_TEXTURES; k++) {
+    if (!env->lazy_surfaces[k])
+      ERROR("IMG_Load: %s\n", lazy_textures[k].file);
+    SDL_Texture **texture =
+        (SDL_Texture **)((char *)env + lazy_textures[k].field);
+    *texture = SDL_CreateTextureFromSurface(ren, env->lazy_surfaces[k]);
+    if (!*texture)
+      ERROR("SDL_CreateTextureFromSurface: %s\n", lazy_textures[k].file);
+    SDL_FreeSurface(env->lazy_surfaces[k]);
+    env->lazy_surfaces[k] = NULL;
+  }
+  env->lazy_textures_loaded = true;
+}
+
 
 /* **************************************************************** */
 
@@ -184,19 +280,12 @@ Env *init(SDL_Window *win, SDL_Renderer *ren, int argc, char *argv[]) {
       fprintf(stderr, "File couldn't open!\n");
       exit(EXIT_FAILURE);
     }
-    if (game_nb_rows(env->g) > MAX_GAME_SIZE ||
-        game_nb_cols(env->g) > MAX_GAME_SIZE) {
-      fprintf(stderr, "Game is too big!\n");
-      exit(EXIT_FAILURE);
-    }
   } else if (argc == 1) {
     env->g = game_default();
   } else {
     fprintf(stderr, "Wrong number of arguments!\n");
     exit(EXIT_FAILURE);
   }
-  env->max_game_cols_reached = game_nb_cols(env->g);
-  env->max_game_rows_reached = game_nb_rows(env->g);
 
   /* home screen textures */
   env->home_screen = IMG_LoadTexture(ren, HOME_SCREEN);
@@ -210,135 +299,65 @@ Env *init(SDL_Window *win, SDL_Renderer *ren, int argc, char *argv[]) {
   env->exit_button = IMG_LoadTexture(ren, EXIT_BUTTON);
   if (!env->exit_button) ERROR("IMG_LoadTexture: %s\n", EXIT_BUTTON);
 
-  /* help screen textures */
-  env->help_screen = IMG_LoadTexture(ren, HELP_SCREEN);
-  if (!env->help_screen) ERROR("IMG_LoadTexture: %s\n", HELP_SCREEN);
-  env->help_screen_vert = IMG_LoadTexture(ren, HELP_SCREEN_VERT);
-  if (!env->help_screen_vert) ERROR("IMG_LoadTexture: %s\n", HELP_SCREEN_VERT);
-  env->back_button = IMG_LoadTexture(ren, BACK_BUTTON);
-  if (!env->back_button) ERROR("IMG_LoadTexture: %s\n", BACK_BUTTON);
-
-  /* game screen textures */
-  env->home_button = IMG_LoadTexture(ren, HOME_BUTTON);
-  if (!env->home_button) ERROR("IMG_LoadTexture: %s\n", HOME_BUTTON);
-  env->help_button_j = IMG_LoadTexture(ren, HELP_BUTTON_J);
-  if (!env->help_button_j) ERROR("IMG_LoadTexture: %s\n", HELP_BUTTON_J);
-  env->tree = IMG_LoadTexture(ren, PALM_TREE);
-  if (!env->tree) ERROR("IMG_LoadTexture: %s\n", PALM_TREE);
-  env->water = IMG_LoadTexture(ren, WATER);
-  if (!env->water) ERROR("IMG_LoadTexture: %s\n", WATER);
-  env->raft = IMG_LoadTexture(ren, RAFT);
-  if (!env->raft) ERROR("IMG_LoadTexture: %s\n", RAFT);
-  env->losing_water = IMG_LoadTexture(ren, L_WATER);
-  if (!env->losing_water) ERROR("IMG_LoadTexture: %s\n", L_WATER);
-  env->losing_raft = IMG_LoadTexture(ren, L_RAFT);
-  if (!env->losing_raft) ERROR("IMG_LoadTexture: %s\n", L_RAFT);
-  env->game_screen = IMG_LoadTexture(ren, GAME_SCREEN);
-  if (!env->game_screen) ERROR("IMG_LoadTexture: %s\n", GAME_SCREEN);
-  env->game_screen_vert = IMG_LoadTexture(ren, GAME_SCREEN_VERT);
-  if (!env->game_screen_vert) ERROR("IMG_LoadTexture: %s\n", GAME_SCREEN_VERT);
-  env->solve = IMG_LoadTexture(ren, SOLVE);
-  if (!env->solve) ERROR("IMG_LoadTexture: %s\n", SOLVE);
-  env->restart = IMG_LoadTexture(ren, RESTART);
-  if (!env->restart) ERROR("IMG_LoadTexture: %s\n", RESTART);
-  env->undo = IMG_LoadTexture(ren, UNDO);
-  if (!env->undo) ERROR("IMG_LoadTexture: %s\n", UNDO);
-  env->redo = IMG_LoadTexture(ren, REDO);
-  if (!env->redo) ERROR("IMG_LoadTexture: %s\n", REDO);
-
-  /* game_over and end screens */
-  env->game_over_screen = IMG_LoadTexture(ren, GAME_OVER_SCREEN);
-  if (!env->game_over_screen) ERROR("IMG_LoadTexture: %s\n", GAME_OVER_SCREEN);
-  env->game_over_screen_vert = IMG_LoadTexture(ren, GAME_OVER_SCREEN_VERT);
-  if (!env->game_over_screen_vert)
-    ERROR("IMG_LoadTexture: %s\n", GAME_OVER_SCREEN_VERT);
-  env->end_screen = IMG_LoadTexture(ren, END_SCREEN);
-  if (!env->end_screen) ERROR("IMG_LoadTexture: %s\n", END_SCREEN);
-  env->end_screen_vert = IMG_LoadTexture(ren, END_SCREEN_VERT);
-  if (!env->end_screen_vert) ERROR("IMG_LoadTexture: %s\n", END_SCREEN_VERT);
-  env->next_level_button = IMG_LoadTexture(ren, NEXT_LEVEL);
-  if (!env->next_level_button) ERROR("IMG_LoadTexture: %s\n", NEXT_LEVEL);
-  env->previous_level_button = IMG_LoadTexture(ren, PREVIOUS_LEVEL);
-  if (!env->previous_level_button)
-    ERROR("IMG_LoadTexture: %s\n", PREVIOUS_LEVEL);
-  env->restart_game_over_button = IMG_LoadTexture(ren, RESTART_GAMEOVER);
-  if (!env->restart_game_over_button)
-    ERROR("IMG_LoadTexture: %s\n", RESTART_GAMEOVER);
-  env->quit_button = IMG_LoadTexture(ren, QUIT_GAMEOVER);
-  if (!env->restart_game_over_button)
-    ERROR("IMG_LoadTexture: %s\n", QUIT_GAMEOVER);
+  /* the other textures are decoded while the home screen is shown */
+  for (uint k = 0; k < NB_LAZY_TEXTURES; k++) {
+    env->lazy_surfaces[k] = NULL;
+  }
+  env->lazy_textures_loaded = false;
+  env->decoding_thread =
+      SDL_CreateThread(decode_lazy_textures, "decode_textures", env);
+  if (!env->decoding_thread) ERROR("SDL_CreateThread: %s\n", SDL_GetError());
 
   env->current_level = 0;
   env->current_screen = HOME;
   env->previous_screen = HOME;
   env->restricted_by_height = true;
   env->switch_button = true;
-  env->switch_1 = IMG_LoadTexture(ren, SWITCH_1);
-  if (!env->switch_1) ERROR("IMG_LoadTexture: %s\n", SWITCH_1);
-  env->switch_2 = IMG_LoadTexture(ren, SWITCH_2);
-  if (!env->switch_2) ERROR("IMG_LoadTexture: %s\n", SWITCH_2);
+  env->dirty = true;
+  env->show_hint = false;
+  env->static_layer = NULL;
+  env->static_layer_up_to_date = false;
+  env->grid_beginning_x = 0;
+  env->grid_beginning_y = 0;
+  env->cell_size = 1;
+  env->view_cell_size = 1;
+  env->view.x = env->view.y = env->view.w = env->view.h = 0;
+  env->gesture_active = false;
+  env->solving = NULL;
+  env->solve_event = SDL_RegisterEvents(1);
+  level_changed(env);
 
   int w, h;
   SDL_GetWindowSize(win, &w, &h);
 
-  /* level text */
-  create_level_text(win, ren, env);
-
-  /* nb_tents text */
-  env->text =
-      (SDL_Texture **)malloc(sizeof(SDL_Texture *) * (MAX_GAME_SIZE * 2));
-  create_tents_text(win, ren, env);
-
-  /* wrapping and diagadj text */
+  /* glyph atlases of the level, numbers of tents and wrapping/diagadj texts */
   SDL_Color color = TEXT_COLOR;  // black
-  TTF_Font *font = TTF_OpenFont(FONT_LEVEL, FONT_SIZE);
-  if (!font) ERROR("TTF_OpenFont: %s\n", FONT);
-  TTF_SetFontStyle(font, TTF_STYLE_BOLD);
-  if (game_is_wrapping(env->g)) {
-    SDL_Surface *surf = TTF_RenderText_Blended(
-        font, "WRAPPING : ON", color);  // blended rendering for ultra nice text
-    env->wrapping_text = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-  } else {
-    SDL_Surface *surf =
-        TTF_RenderText_Blended(font, "WRAPPING : OFF",
-                               color);  // blended rendering for ultra nice text
-    env->wrapping_text = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-  }
-  SDL_Rect rect;
-  SDL_QueryTexture(env->wrapping_text, NULL, NULL, &rect.w, &rect.h);
-  env->wrap_diag_ratio = rect.w / rect.h;
-  if (game_is_diagadj(env->g)) {
-    SDL_Surface *surf = TTF_RenderText_Blended(
-        font, "DIAGADJ : ON", color);  // blended rendering for ultra nice text
-    env->diagadj_text = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-  } else {
-    SDL_Surface *surf = TTF_RenderText_Blended(
-        font, "DIAGADJ : OFF", color);  // blended rendering for ultra nice text
-    env->diagadj_text = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-  }
-  TTF_CloseFont(font);
-  char *levels[] = {"games/level10.tnt", "games/level9.tnt", "games/level8.tnt",
-                    "games/level7.tnt",  "games/level6.tnt", "games/level5.tnt",
-                    "games/level4.tnt",  "games/level3.tnt", "games/level2.tnt",
-                    "games/level1.tnt"};
-#ifdef __ANDROID__
-  char *levels_android[] = {
-      "level10.tnt", "level9.tnt", "level8.tnt", "level7.tnt", "level6.tnt",
-      "level5.tnt",  "level4.tnt", "level3.tnt", "level2.tnt", "level1.tnt"};
-#endif
-
-  env->games = dlist_create_empty();
-  for (uint i = 0; i < 10; i++) {
+  env->level_glyphs = glyph_atlas_new(ren, FONT_LEVEL, ATLAS_FONT_SIZE,
+                                      TTF_STYLE_NORMAL, color, ATLAS_CHARS);
+  env->label_glyphs = glyph_atlas_new(ren, FONT_LEVEL, ATLAS_FONT_SIZE,
+                                      TTF_STYLE_BOLD, color, ATLAS_CHARS);
+  env->tents_glyphs = glyph_atlas_new(ren, FONT, ATLAS_FONT_SIZE,
+                                      TTF_STYLE_BOLD, color, ATLAS_DIGITS);
 #ifdef __ANDROID__
-    env->games = dlist_prepend(env->games, levels_android[i]);
+  char *levels[] = {"level1.tnt", "level2.tnt", "level3.tnt", "level4.tnt",
+                    "level5.tnt", "level6.tnt", "level7.tnt", "level8.tnt",
+                    "level9.tnt", "level10.tnt"};
 #else
-    env->games = dlist_prepend(env->games, levels[i]);
+  char *levels[] = {"games/level1.tnt", "games/level2.tnt", "games/level3.tnt",
+                    "games/level4.tnt", "games/level5.tnt", "games/level6.tnt",
+                    "games/level7.tnt", "games/level8.tnt", "games/level9.tnt",
+                    "games/level10.tnt"};
 #endif
+  /* the solutions found are kept from one run to the next */
+  char *pref_path = SDL_GetPrefPath("A62E", "Tents");
+  if (pref_path) {
+    char cache_file[1024];
+    snprintf(cache_file, sizeof(cache_file), "%ssolutions.cache", pref_path);
+    if (!solution_cache_open(cache_file))
+      PRINT("Can't open the solution cache %s\n", cache_file);
+    SDL_free(pref_path);
   }
+  env->levels = level_pack_load(sizeof(levels) / sizeof(levels[0]), levels);
   return env;
 }
 
@@ -346,6 +365,10 @@ Env *init(SDL_Window *win, SDL_Renderer *ren, int argc, char *argv[]) {
 
 void render(SDL_Window *win, SDL_Renderer *ren,
             Env *env) { /* PUT YOUR CODE HERE TO RENDER TEXTURES, ... */
+  env->dirty = false;
+  if (env->current_screen != HOME) {
+    load_lazy_textures(ren, env);
+  }
   if (env->current_screen == HOME) {
     render_home(win, ren, env);
   } else if (env->current_screen == GAME) {
@@ -424,15 +447,10 @@ void render_help(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   }
 }
 
-void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
-  int w, h;
-  SDL_GetWindowSize(win, &w, &h);
+/* draws what only changes with the level or the window size: background,
+ * level text, trees, grid lines and numbers of tents */
+void render_static_layer(SDL_Renderer *ren, Env *env, int w, int h) {
   SDL_Rect rect;
-  rect.x = 0;
-  rect.y = 0;
-  rect.w = w;
-  rect.h = h;
-
   /* render background texture */
   SDL_SetRenderDrawColor(ren, 255, 255, 255, SDL_ALPHA_OPAQUE);
   if (w > h) {
@@ -441,6 +459,140 @@ void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
     SDL_RenderCopy(ren, env->game_screen_vert, NULL, NULL);
   }
 
+  /* render current level text */
+  char text[20];
+  sprintf(text, "LEVEL %u", env->current_level);
+  float level_ratio = glyph_atlas_ratio(env->level_glyphs, text);
+  if (env->restricted_by_height) {
+    rect.h = (int)(ABOVE_GRID_RATIO * h / 3);
+    rect.w = (int)(rect.h * level_ratio);
+  } else {
+    rect.h = (int)(env->grid_beginning_y / 3);
+    rect.w = (int)(rect.h * level_ratio);
+    if (rect.w > env->grid_width * 3 / 4) {
+      rect.w = (int)(env->grid_width * 3 / 4);
+      rect.h = (int)rect.w / level_ratio;
+    }
+  }
+  rect.x = (int)(w / 2 - rect.w / 2);
+  rect.y = (int)(rect.h / 2);
+  glyph_atlas_draw(ren, env->level_glyphs, text, &rect);
+
+  /* render grid background */
+  SDL_RenderFillRect(ren, &env->view);
+
+  /* only the cells in view are drawn, the partly visible ones are clipped */
+  uint first_row, end_row, first_col, end_col;
+  visible_cells(env, &first_row, &end_row, &first_col, &end_col);
+  int grid_x = env->view.x - env->pan_x;
+  int grid_y = env->view.y - env->pan_y;
+  int size = env->view_cell_size;
+  SDL_RenderSetClipRect(ren, &env->view);
+
+  /* render the trees */
+  for (uint i = first_row; i < end_row; i++) {
+    for (uint j = first_col; j < end_col; j++) {
+      if (game_get_square(env->g, i, j) == TREE) {
+        rect.x = grid_x + j * size;
+        rect.y = grid_y + i * size;
+        rect.w = size;
+        rect.h = size;
+        SDL_RenderCopy(ren, env->tree, NULL, &rect);
+      }
+    }
+  }
+
+  /* render the grid */
+  SDL_SetRenderDrawColor(ren, 0, 0, 0, SDL_ALPHA_OPAQUE); /* black */
+  for (uint j = first_col; j <= end_col; j++) {
+    SDL_RenderDrawLine(ren, grid_x + j * size, grid_y + first_row * size,
+                       grid_x + j * size, grid_y + end_row * size);
+  }
+  for (uint i = first_row; i <= end_row; i++) {
+    SDL_RenderDrawLine(ren, grid_x + first_col * size, grid_y + i * size,
+                       grid_x + end_col * size, grid_y + i * size);
+  }
+
+  /*render the nb_tents text, centered below and on the right of the grid*/
+  SDL_Rect clip = {env->view.x + env->view.w, env->view.y, size,
+                   env->view.h};
+  SDL_RenderSetClipRect(ren, &clip);
+  rect.h = (int)(FONT_RATIO * size);
+  for (uint i = first_row; i < end_row; i++) {
+    sprintf(text, "%u", game_get_expected_nb_tents_row(env->g, i));
+    rect.w = (int)(rect.h * glyph_atlas_ratio(env->tents_glyphs, text));
+    rect.x = env->view.x + env->view.w + (size - rect.w) / 2;
+    rect.y = grid_y + size * i + (int)((1 - FONT_RATIO) / 2 * size);
+    glyph_atlas_draw(ren, env->tents_glyphs, text, &rect);
+  }
+  clip.x = env->view.x;
+  clip.y = env->view.y + env->view.h;
+  clip.w = env->view.w;
+  clip.h = size;
+  SDL_RenderSetClipRect(ren, &clip);
+  for (uint j = first_col; j < end_col; j++) {
+    sprintf(text, "%u", game_get_expected_nb_tents_col(env->g, j));
+    rect.w = (int)(rect.h * glyph_atlas_ratio(env->tents_glyphs, text));
+    rect.y = env->view.y + env->view.h + (int)((1 - FONT_RATIO) / 2 * size);
+    rect.x = grid_x + size * j + (size - rect.w) / 2;
+    glyph_atlas_draw(ren, env->tents_glyphs, text, &rect);
+  }
+  SDL_RenderSetClipRect(ren, NULL);
+
+#ifndef __ANDROID__
+  /*render wrapping and diagadj texts*/
+  const char *wrapping_text =
+      game_is_wrapping(env->g) ? "WRAPPING : ON" : "WRAPPING : OFF";
+  const char *diagadj_text =
+      game_is_diagadj(env->g) ? "DIAGADJ : ON" : "DIAGADJ : OFF";
+  rect.h = (int)(env->grid_width / 4 /
+                 glyph_atlas_ratio(env->label_glyphs, "WRAPPING : OFF"));
+  rect.w = (int)(rect.h * glyph_atlas_ratio(env->label_glyphs, wrapping_text));
+  rect.x = env->grid_beginning_x;
+  rect.y = (int)(env->grid_beginning_y - rect.h * 2.4);
+  glyph_atlas_draw(ren, env->label_glyphs, wrapping_text, &rect);
+  rect.w = (int)(rect.h * glyph_atlas_ratio(env->label_glyphs, diagadj_text));
+  rect.x = env->grid_beginning_x;
+  rect.y = (int)(env->grid_beginning_y - rect.h * 1.3);
+  glyph_atlas_draw(ren, env->label_glyphs, diagadj_text, &rect);
+#endif
+}
+
+/* draws the static layer in its texture again if it is out of date, and returns
+ * false if the renderer can't draw into a texture */
+bool update_static_layer(SDL_Renderer *ren, Env *env, int w, int h) {
+  if (!SDL_RenderTargetSupported(ren)) {
+    return false;
+  }
+  if (env->static_layer != NULL && env->static_layer_up_to_date &&
+      env->static_layer_w == w && env->static_layer_h == h) {
+    return true;
+  }
+  if (env->static_layer == NULL || env->static_layer_w != w ||
+      env->static_layer_h != h) {
+    if (env->static_layer != NULL) {
+      SDL_DestroyTexture(env->static_layer);
+    }
+    env->static_layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!env->static_layer) {
+      return false;
+    }
+    env->static_layer_w = w;
+    env->static_layer_h = h;
+  }
+  SDL_SetRenderTarget(ren, env->static_layer);
+  render_static_layer(ren, env, w, h);
+  SDL_SetRenderTarget(ren, NULL);
+  env->static_layer_up_to_date = true;
+  return true;
+}
+
+void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
+  int w, h;
+  SDL_GetWindowSize(win, &w, &h);
+  SDL_Rect rect;
+
   uint space_avail_per_cell_x =
       (int)((w - w * 2 * LEFT_FROM_GRID_RATIO) / (game_nb_cols(env->g) + 1));
   uint space_avail_per_cell_y =
@@ -465,88 +617,71 @@ void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
     }
     env->grid_beginning_x = (int)(w * LEFT_FROM_GRID_RATIO);
   }
+  if (env->cell_size < 1) {
+    env->cell_size = 1;
+  }
   env->grid_width = env->cell_size * game_nb_cols(env->g);
-  /* render current level text */
-  if (env->restricted_by_height) {
-    rect.h = (int)(ABOVE_GRID_RATIO * h / 3);
-    rect.w = (int)(rect.h * env->level_ratio);
+  update_view(env);
+
+  /* render the static layer, from its texture if the renderer can keep it */
+  if (update_static_layer(ren, env, w, h)) {
+    SDL_RenderCopy(ren, env->static_layer, NULL, NULL);
   } else {
-    rect.h = (int)(env->grid_beginning_y / 3);
-    rect.w = (int)(rect.h * env->level_ratio);
-    if (rect.w > env->grid_width * 3 / 4) {
-      rect.w = (int)(env->grid_width * 3 / 4);
-      rect.h = (int)rect.w / env->level_ratio;
-    }
+    render_static_layer(ren, env, w, h);
   }
-  rect.x = (int)(w / 2 - rect.w / 2);
-  rect.y = (int)(rect.h / 2);
-  SDL_RenderCopy(ren, env->current_level_text, NULL, &rect);
 
-  /* render grid background */
-  rect.x = env->grid_beginning_x;
-  rect.y = env->grid_beginning_y;
-  rect.w = env->grid_width;
-  rect.h = env->cell_size * game_nb_rows(env->g);
-  SDL_RenderFillRect(ren, &rect);
-
-  /* render the tents, water and trees */
-  for (uint i = 0; i < game_nb_rows(env->g); i++) {
-    for (uint j = 0; j < game_nb_cols(env->g); j++) {
-      rect.x = env->grid_beginning_x + j * env->cell_size;
-      rect.y = env->grid_beginning_y + i * env->cell_size;
-      rect.w = env->cell_size;
-      rect.h = env->cell_size;
-      if (game_get_square(env->g, i, j) == TREE) {
-        SDL_RenderCopy(ren, env->tree, NULL, &rect);
-      } else if (game_get_square(env->g, i, j) == GRASS) {
-        if (game_check_move(env->g, i, j, GRASS) == REGULAR) {
-          SDL_RenderCopy(ren, env->water, NULL, &rect);
-        } else if (game_check_move(env->g, i, j, GRASS) == LOSING) {
+  /* render the tents and water in view, inside the grid lines */
+  uint first_row, end_row, first_col, end_col;
+  visible_cells(env, &first_row, &end_row, &first_col, &end_col);
+  int size = env->view_cell_size;
+  SDL_RenderSetClipRect(ren, &env->view);
+  for (uint i = first_row; i < end_row; i++) {
+    for (uint j = first_col; j < end_col; j++) {
+      rect.x = env->view.x - env->pan_x + j * size + 1;
+      rect.y = env->view.y - env->pan_y + i * size + 1;
+      rect.w = size - 1;
+      rect.h = size - 1;
+      if (game_get_square(env->g, i, j) == GRASS) {
+        // the losing squares are cached by the game, so this is cheap
+        if (game_is_losing_square(env->g, i, j)) {
           SDL_RenderCopy(ren, env->losing_water, NULL, &rect);
+        } else {
+          SDL_RenderCopy(ren, env->water, NULL, &rect);
         }
       } else if (game_get_square(env->g, i, j) == TENT) {
-        if (game_check_move(env->g, i, j, TENT) == REGULAR) {
-          SDL_RenderCopy(ren, env->raft, NULL, &rect);
-        } else if (game_check_move(env->g, i, j, TENT) == LOSING) {
+        if (game_is_losing_square(env->g, i, j)) {
           SDL_RenderCopy(ren, env->losing_raft, NULL, &rect);
+        } else {
+          SDL_RenderCopy(ren, env->raft, NULL, &rect);
         }
       }
     }
   }
 
-  /* render the grid */
-  SDL_SetRenderDrawColor(ren, 0, 0, 0, SDL_ALPHA_OPAQUE); /* black */
-  for (uint i = 0; i < game_nb_cols(env->g) + 1; i++) {
-    SDL_RenderDrawLine(
-        ren, env->grid_beginning_x + i * env->cell_size, env->grid_beginning_y,
-        env->grid_beginning_x + i * env->cell_size,
-        env->grid_beginning_y + game_nb_rows(env->g) * env->cell_size);
-  }
-  for (uint j = 0; j < game_nb_rows(env->g) + 1; j++) {
-    SDL_RenderDrawLine(
-        ren, env->grid_beginning_x, env->grid_beginning_y + j * env->cell_size,
-        env->grid_beginning_x + game_nb_cols(env->g) * env->cell_size,
-        env->grid_beginning_y + j * env->cell_size);
-  }
-
-  /*render the nb_tents text*/
-  rect.w = (int)(FONT_RATIO / 2 * env->cell_size);
-  rect.h = (int)(FONT_RATIO * env->cell_size);
-  for (uint i = 0; i < (game_nb_rows(env->g)); i++) {
-    rect.x = env->grid_beginning_x + env->grid_width +
-             (int)((1 - FONT_RATIO / 2) / 2 * env->cell_size);
-    rect.y = env->grid_beginning_y + env->cell_size * i +
-             (int)((1 - FONT_RATIO) / 2 * env->cell_size);
-
-    SDL_RenderCopy(ren, env->text[i], NULL, &rect);
-  }
-  for (uint j = 0; j < (game_nb_cols(env->g)); j++) {
-    rect.y = env->grid_beginning_y + game_nb_rows(env->g) * env->cell_size +
-             (int)((1 - FONT_RATIO) / 2 * env->cell_size);
-    rect.x = env->grid_beginning_x + env->cell_size * j +
-             (int)((1 - FONT_RATIO / 2) / 2 * env->cell_size);
-    SDL_RenderCopy(ren, env->text[j + game_nb_rows(env->g)], NULL, &rect);
+  /* render the hint, a pale square in its cell, computed again on each frame
+   * so that it follows the moves */
+  const char *hint_text = NULL;
+  if (env->show_hint) {
+    uint i, j;
+    square s;
+    hint_rule rule = game_hint(env->g, &i, &j, &s);
+    char *hint_texts[] = {"NO HINT", "HINT: RULES", "HINT: TREE",
+                          "HINT: LINE"};
+    hint_text = hint_texts[rule];
+    if (rule != HINT_NONE) {
+      rect.x = env->view.x - env->pan_x + j * size + 1;
+      rect.y = env->view.y - env->pan_y + i * size + 1;
+      rect.w = size - 1;
+      rect.h = size - 1;
+      SDL_Texture *hint = s == TENT ? env->raft : env->water;
+      SDL_SetTextureAlphaMod(hint, 128);
+      SDL_RenderCopy(ren, hint, NULL, &rect);
+      SDL_SetTextureAlphaMod(hint, 255);
+      SDL_SetRenderDrawColor(ren, 255, 215, 0, SDL_ALPHA_OPAQUE);
+      SDL_RenderDrawRect(ren, &rect);
+    }
   }
+  SDL_RenderSetClipRect(ren, NULL);
 
 #ifdef __ANDROID__
   /*render buttons*/
@@ -577,16 +712,6 @@ void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
     SDL_RenderCopy(ren, env->switch_2, NULL, &rect);
   }
 #else
-  /*render wrapping and diagadj texts*/
-  rect.w = (int)(env->grid_width / 4);
-  rect.h = (int)(rect.w / env->wrap_diag_ratio);
-  rect.x = env->grid_beginning_x;
-  rect.y = (int)(env->grid_beginning_y - rect.h * 2.4);
-  SDL_RenderCopy(ren, env->wrapping_text, NULL, &rect);
-  rect.x = env->grid_beginning_x;
-  rect.y = (int)(env->grid_beginning_y - rect.h * 1.3);
-  SDL_RenderCopy(ren, env->diagadj_text, NULL, &rect);
-
   /*render buttons*/
   rect.w = (int)(env->grid_width * 1 / 14);
   rect.h = (int)(env->grid_width * 1 / 14);
@@ -605,6 +730,18 @@ void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   rect.x = env->grid_beginning_x + env->grid_width - (int)(1.5 * rect.w);
   SDL_RenderCopy(ren, env->solve, NULL, &rect);
 #endif
+  /* render the solving indicator over the grid */
+  if (env->solving) {
+    char text[] = "SOLVING...";
+    uint nb_dots = (SDL_GetTicks() - env->solving_since) / DOTS_PERIOD % 4;
+    text[sizeof(text) - 4 + nb_dots] = '\0';
+    rect.h = env->view.h / 10;
+    rect.w = (int)(rect.h * glyph_atlas_ratio(env->label_glyphs, text));
+    rect.x = env->view.x + (env->view.w - rect.w) / 2;
+    rect.y = env->view.y + (env->view.h - rect.h) / 2;
+    glyph_atlas_draw(ren, env->label_glyphs, text, &rect);
+  }
+
   /* render home and help buttons */
   if (env->restricted_by_height) {
     rect.w = (int)w / 15;
@@ -620,6 +757,15 @@ void render_game(SDL_Window *win, SDL_Renderer *ren, Env *env) {
 
   rect.x = (int)(w - rect.w * 1.5);
   SDL_RenderCopy(ren, env->help_button_j, NULL, &rect);
+
+  /* render the rule of the hint between them */
+  if (hint_text != NULL) {
+    rect.h = env->side_button_size / 2;
+    rect.w = (int)(rect.h * glyph_atlas_ratio(env->label_glyphs, hint_text));
+    rect.x = (w - rect.w) / 2;
+    rect.y = (int)(h - 1.25 * env->side_button_size);
+    glyph_atlas_draw(ren, env->label_glyphs, hint_text, &rect);
+  }
 }
 
 void render_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env) {
@@ -738,10 +884,43 @@ void render_end(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   }
 }
 
+bool needs_render(Env *env) {
+  // the solving indicator is animated
+  return env->dirty || env->solving != NULL;
+}
+
+Uint32 wait_timeout(Env *env) {
+  /* a frame while the solving indicator moves, longer when idle */
+  return env->solving != NULL ? FRAME_TIMEOUT : WAIT_TIMEOUT;
+}
+
+bool cell_center(Env *env, uint row, uint col, int *x, int *y) {
+  if (row >= game_nb_rows(env->g) || col >= game_nb_cols(env->g)) {
+    return false;
+  }
+  *x = env->view.x - env->pan_x + col * env->view_cell_size +
+       env->view_cell_size / 2;
+  *y = env->view.y - env->pan_y + row * env->view_cell_size +
+       env->view_cell_size / 2;
+  return *x >= env->view.x && *x < env->view.x + env->view.w &&
+         *y >= env->view.y && *y < env->view.y + env->view.h;
+}
+
 bool process(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
   if (e->type == SDL_QUIT) {
     return true;
   }
+  finish_solving(env);
+  // a motion only changes the window if it plays a move (see process_game),
+  // any other event may change it
+  if (e->type != SDL_MOUSEMOTION && e->type != SDL_FINGERMOTION) {
+    env->dirty = true;
+  }
+  // the content of the render targets is lost with the graphic context
+  if (e->type == SDL_RENDER_TARGETS_RESET ||
+      e->type == SDL_RENDER_DEVICE_RESET) {
+    env->static_layer_up_to_date = false;
+  }
   if (env->current_screen == HOME) {
     return process_home(win, ren, env, e);
   } else if (env->current_screen == GAME) {
@@ -786,8 +965,7 @@ bool process_home(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
   }
 #else
   if (e->type == SDL_MOUSEBUTTONDOWN) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point mouse = {e->button.x, e->button.y};
     // check if mouse is pressing one of the buttons
     // start game
     if (w > h) {
@@ -862,8 +1040,7 @@ bool process_help(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
   }
 #else
   if (e->type == SDL_MOUSEBUTTONDOWN) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point mouse = {e->button.x, e->button.y};
     if (w > h) {
       // check if mouse is pressing one of the buttons
       // start game
@@ -894,7 +1071,8 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
     render(win, ren, env);
     SDL_RenderPresent(ren);
     SDL_Delay(600);
-    if (env->current_level == 10) {
+    env->dirty = true;
+    if (env->current_level == level_pack_size(env->levels)) {
       env->current_screen = END;
       return false;
     } else {
@@ -905,6 +1083,7 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
   SDL_GetWindowSize(win, &w, &h);
 #ifdef __ANDROID__
   if (e->type == SDL_FINGERDOWN) {
+    env->gesture_active = false;  // a pinch starts again from here
     // check if mouse is pressing one of the buttons
     // start game
     if (e->tfinger.x * w < w * 2 / 10 && e->tfinger.x * w > w * 1 / 10 &&
@@ -932,15 +1111,12 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
              e->tfinger.y * h <
                  w * 1 / 10 + env->grid_beginning_y - w * 1 / 10 * 5 / 4 &&
              e->tfinger.y * h > env->grid_beginning_y - w * 1 / 10 * 5 / 4) {
-      for (uint i = 0; i < game_nb_rows(env->g); i++) {
-        for (uint j = 0; j < game_nb_cols(env->g); j++) {
-          if (game_get_square(env->g, i, j) == TENT ||
-              game_get_square(env->g, i, j) == GRASS) {
-            game_set_square(env->g, i, j, EMPTY);
-          }
-        }
+      // a second press cancels the solve
+      if (env->solving) {
+        cancel_solving(env);
+      } else {
+        start_solving(env);
       }
-      game_solve(env->g);
     }
     // switch button press
     else if (e->tfinger.x * w < w * 1 / 2 + w * 1 / 6 &&
@@ -976,12 +1152,11 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
         env->previous_screen = GAME;
       }
     }
-    // convert mouse position to cell in grid
-    if (mouse_is_in_grid(env, (int)(e->tfinger.x * w),
-                         (int)(e->tfinger.y * h))) {
-      uint row, col;
-      row = (uint)(e->tfinger.y * h - env->grid_beginning_y) / env->cell_size;
-      col = (uint)(e->tfinger.x * w - env->grid_beginning_x) / env->cell_size;
+    // convert mouse position to cell in grid, unless the player is pinching
+    uint row, col;
+    if (SDL_GetNumTouchFingers(e->tfinger.touchId) == 1 &&
+        cell_at(env, (int)(e->tfinger.x * w), (int)(e->tfinger.y * h), &row,
+                &col)) {
       if (env->switch_button == true) {
         if (game_get_square(env->g, row, col) == TENT ||
             game_get_square(env->g, row, col) == GRASS) {
@@ -998,27 +1173,40 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
         }
       }
     }
+  } else if (e->type == SDL_MULTIGESTURE) {
+    // pinch to zoom, and move the fingers together to move the grid
+    int x = (int)(e->mgesture.x * w);
+    int y = (int)(e->mgesture.y * h);
+    zoom_view(env, 1 + e->mgesture.dDist * PINCH_SPEED, x, y);
+    if (env->gesture_active) {
+      pan_view(env, env->gesture_x - x, env->gesture_y - y);
+    }
+    env->gesture_active = true;
+    env->gesture_x = x;
+    env->gesture_y = y;
+  } else if (e->type == SDL_FINGERUP) {
+    env->gesture_active = false;
   } else if (e->type == SDL_FINGERMOTION) {
-    if (mouse_is_in_grid(env, (int)(e->tfinger.x * w),
-                         (int)(e->tfinger.y * h))) {
-      uint row, col;
-      row = (uint)(e->tfinger.y * h - env->grid_beginning_y) / env->cell_size;
-      col = (uint)(e->tfinger.x * w - env->grid_beginning_x) / env->cell_size;
+    uint row, col;
+    if (SDL_GetNumTouchFingers(e->tfinger.touchId) == 1 &&
+        cell_at(env, (int)(e->tfinger.x * w), (int)(e->tfinger.y * h), &row,
+                &col)) {
       if (env->switch_button == true) {
         if (game_get_square(env->g, row, col) == EMPTY) {
           game_play_move(env->g, row, col, TENT);
+          env->dirty = true;
         }
       } else {
         if (game_get_square(env->g, row, col) == EMPTY) {
           game_play_move(env->g, row, col, GRASS);
+          env->dirty = true;
         }
       }
     }
   }
 #else
   if (e->type == SDL_MOUSEBUTTONDOWN) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point mouse = {e->button.x, e->button.y};
     // check if mouse is pressing one of the buttons
     // undo the last move
     if (mouse.x > env->grid_beginning_x + env->grid_width / 2 -
@@ -1057,15 +1245,12 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
                       (0.5 * env->small_button_size)) {
       if (mouse.y > env->grid_beginning_y - (env->small_button_size * 5 / 4) &&
           mouse.y < env->grid_beginning_y - (env->small_button_size * 1 / 4)) {
-        for (uint i = 0; i < game_nb_rows(env->g); i++) {
-          for (uint j = 0; j < game_nb_cols(env->g); j++) {
-            if (game_get_square(env->g, i, j) == TENT ||
-                game_get_square(env->g, i, j) == GRASS) {
-              game_set_square(env->g, i, j, EMPTY);
-            }
-          }
+        // a second click cancels the solve
+        if (env->solving) {
+          cancel_solving(env);
+        } else {
+          start_solving(env);
         }
-        game_solve(env->g);
       }
     }
     // go to the home page
@@ -1087,10 +1272,8 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
       }
     }
     // convert mouse position to cell in grid
-    if (mouse_is_in_grid(env, mouse.x, mouse.y)) {
-      uint row, col;
-      row = (uint)(mouse.y - env->grid_beginning_y) / env->cell_size;
-      col = (uint)(mouse.x - env->grid_beginning_x) / env->cell_size;
+    uint row, col;
+    if (cell_at(env, mouse.x, mouse.y, &row, &col)) {
       if (e->button.button == SDL_BUTTON_LEFT) {
         if (game_get_square(env->g, row, col) == TENT ||
             game_get_square(env->g, row, col) == GRASS) {
@@ -1107,22 +1290,26 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
         }
       }
     }
+  } else if (e->type == SDL_MOUSEMOTION &&
+             (e->motion.state & SDL_BUTTON_MMASK)) {
+    // drag the grid with the middle button
+    pan_view(env, -e->motion.xrel, -e->motion.yrel);
+    env->dirty = true;
   } else if (e->type == SDL_MOUSEMOTION) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
-    if (mouse_is_in_grid(env, mouse.x, mouse.y)) {
-      uint row, col;
-      row = (uint)(mouse.y - env->grid_beginning_y) / env->cell_size;
-      col = (uint)(mouse.x - env->grid_beginning_x) / env->cell_size;
+    SDL_Point mouse = {e->motion.x, e->motion.y};
+    uint row, col;
+    if (cell_at(env, mouse.x, mouse.y, &row, &col)) {
       if (e->button.button == SDL_BUTTON_LEFT) {
         if (game_get_square(env->g, row, col) == EMPTY) {
           game_play_move(env->g, row, col, TENT);
+          env->dirty = true;
         }
       } else if (e->button.button ==
                  SDL_BUTTON(SDL_BUTTON_RIGHT)) {  // bug with SDL_BUTTON_RIGHT
                                                   // on its own
         if (game_get_square(env->g, row, col) == EMPTY) {
           game_play_move(env->g, row, col, GRASS);
+          env->dirty = true;
         }
       }
     }
@@ -1136,6 +1323,42 @@ bool process_game(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
     if (e->key.keysym.sym == SDLK_r) {
       game_redo(env->g);
     }
+    // show or hide the next deduction
+    if (e->key.keysym.sym == SDLK_h) {
+      env->show_hint = !env->show_hint;
+    }
+    // zoom with + and -, and move the grid with the arrows
+    int center_x = env->view.x + env->view.w / 2;
+    int center_y = env->view.y + env->view.h / 2;
+    if (e->key.keysym.sym == SDLK_PLUS || e->key.keysym.sym == SDLK_EQUALS ||
+        e->key.keysym.sym == SDLK_KP_PLUS) {
+      zoom_view(env, ZOOM_STEP, center_x, center_y);
+    }
+    if (e->key.keysym.sym == SDLK_MINUS || e->key.keysym.sym == SDLK_KP_MINUS) {
+      zoom_view(env, 1 / ZOOM_STEP, center_x, center_y);
+    }
+    if (e->key.keysym.sym == SDLK_LEFT) {
+      pan_view(env, -env->view_cell_size, 0);
+    }
+    if (e->key.keysym.sym == SDLK_RIGHT) {
+      pan_view(env, env->view_cell_size, 0);
+    }
+    if (e->key.keysym.sym == SDLK_UP) {
+      pan_view(env, 0, -env->view_cell_size);
+    }
+    if (e->key.keysym.sym == SDLK_DOWN) {
+      pan_view(env, 0, env->view_cell_size);
+    }
+  }
+  // zoom with the mouse wheel, around the mouse
+  else if (e->type == SDL_MOUSEWHEEL) {
+    SDL_Point mouse;
+    SDL_GetMouseState(&mouse.x, &mouse.y);
+    if (e->wheel.y > 0) {
+      zoom_view(env, ZOOM_STEP, mouse.x, mouse.y);
+    } else if (e->wheel.y < 0) {
+      zoom_view(env, 1 / ZOOM_STEP, mouse.x, mouse.y);
+    }
   }
 #endif
   return false;
@@ -1171,25 +1394,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                 (e->tfinger.x * w > w * 1 / 3 && e->tfinger.x * w < w * 2 / 3 &&
                  e->tfinger.y * h > h * 1 / 4 &&
                  e->tfinger.y * h < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        if (env->current_level == 1) {
-          env->games = dlist_next(env->games);
-        }
-        env->current_level++;
-        char *level = dlist_data(env->games);
-        const char *dir = SDL_AndroidGetInternalStoragePath();
-        char filename[1024];
-        sprintf(filename, "%s/%s", dir, level);
-        copy_asset(level, filename);
-        env->g = game_load(filename);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
-        if (game_nb_cols(env->g) > env->max_game_cols_reached) {
-          env->max_game_cols_reached = game_nb_cols(env->g);
-        }
-        if (game_nb_rows(env->g) > env->max_game_rows_reached) {
-          env->max_game_rows_reached = game_nb_rows(env->g);
-        }
+        go_to_level(env, env->current_level + 1);
         env->current_screen = GAME;
         return false;
       }
@@ -1227,17 +1432,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                            e->tfinger.x * w < w * 1 / 9 + w * 1 / 3 &&
                            e->tfinger.y * h > h * 1 / 4 &&
                            e->tfinger.y * h < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        env->games = dlist_prev(env->games);
-        env->current_level--;
-        char *level = dlist_data(env->games);
-        const char *dir = SDL_AndroidGetInternalStoragePath();
-        char filename[1024];
-        sprintf(filename, "%s/%s", dir, level);
-        copy_asset(level, filename);
-        env->g = game_load(filename);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
+        go_to_level(env, env->current_level - 1);
         env->current_screen = GAME;
         return false;
       }
@@ -1250,23 +1445,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                            e->tfinger.x * w < w * 10 / 18 + w * 1 / 3 &&
                            e->tfinger.y * h > h * 1 / 4 &&
                            e->tfinger.y * h < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        env->games = dlist_next(env->games);
-        env->current_level++;
-        char *level = dlist_data(env->games);
-        const char *dir = SDL_AndroidGetInternalStoragePath();
-        char filename[1024];
-        sprintf(filename, "%s/%s", dir, level);
-        copy_asset(level, filename);
-        env->g = game_load(filename);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
-        if (game_nb_cols(env->g) > env->max_game_cols_reached) {
-          env->max_game_cols_reached = game_nb_cols(env->g);
-        }
-        if (game_nb_rows(env->g) > env->max_game_rows_reached) {
-          env->max_game_rows_reached = game_nb_rows(env->g);
-        }
+        go_to_level(env, env->current_level + 1);
         env->current_screen = GAME;
         return false;
         return false;
@@ -1286,8 +1465,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
   }
 #else
   if (e->type == SDL_MOUSEBUTTONDOWN) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point mouse = {e->button.x, e->button.y};
     if (env->current_level == 0 || env->current_level == 1) {
       // player presses restart button
       if ((w > h &&
@@ -1309,21 +1487,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                (w <= h &&
                 (mouse.x > w * 1 / 3 && mouse.x < w * 2 / 3 &&
                  mouse.y > h * 1 / 4 && mouse.y < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        if (env->current_level == 1) {
-          env->games = dlist_next(env->games);
-        }
-        env->current_level++;
-        char *level = dlist_data(env->games);
-        env->g = game_load(level);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
-        if (game_nb_cols(env->g) > env->max_game_cols_reached) {
-          env->max_game_cols_reached = game_nb_cols(env->g);
-        }
-        if (game_nb_rows(env->g) > env->max_game_rows_reached) {
-          env->max_game_rows_reached = game_nb_rows(env->g);
-        }
+        go_to_level(env, env->current_level + 1);
         env->current_screen = GAME;
         return false;
       }
@@ -1358,13 +1522,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                (w <= h &&
                 (mouse.x > w * 1 / 9 && mouse.x < w * 1 / 9 + w * 1 / 3 &&
                  mouse.y > h * 1 / 4 && mouse.y < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        env->games = dlist_prev(env->games);
-        env->current_level--;
-        char *level = dlist_data(env->games);
-        env->g = game_load(level);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
+        go_to_level(env, env->current_level - 1);
         env->current_screen = GAME;
         return false;
       }
@@ -1376,19 +1534,7 @@ bool process_game_over(SDL_Window *win, SDL_Renderer *ren, Env *env,
                (w <= h &&
                 (mouse.x > w * 10 / 18 && mouse.x < w * 10 / 18 + w * 1 / 3 &&
                  mouse.y > h * 1 / 4 && mouse.y < h * 1 / 4 + h * 1 / 12))) {
-        game_delete(env->g);
-        env->games = dlist_next(env->games);
-        env->current_level++;
-        char *level = dlist_data(env->games);
-        env->g = game_load(level);
-        create_level_text(win, ren, env);
-        create_tents_text(win, ren, env);
-        if (game_nb_cols(env->g) > env->max_game_cols_reached) {
-          env->max_game_cols_reached = game_nb_cols(env->g);
-        }
-        if (game_nb_rows(env->g) > env->max_game_rows_reached) {
-          env->max_game_rows_reached = game_nb_rows(env->g);
-        }
+        go_to_level(env, env->current_level + 1);
         env->current_screen = GAME;
         return false;
       }
@@ -1437,17 +1583,7 @@ bool process_end(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
               (e->tfinger.x * w > w * 1 / 3 && e->tfinger.x * w < w * 2 / 3 &&
                e->tfinger.y * h > h * 1 / 4 &&
                e->tfinger.y * h < h * 1 / 4 + h * 1 / 12))) {
-      game_delete(env->g);
-      env->games = dlist_prev(env->games);
-      env->current_level--;
-      char *level = dlist_data(env->games);
-      const char *dir = SDL_AndroidGetInternalStoragePath();
-      char filename[1024];
-      sprintf(filename, "%s/%s", dir, level);
-      copy_asset(level, filename);
-      env->g = game_load(filename);
-      create_level_text(win, ren, env);
-      create_tents_text(win, ren, env);
+      go_to_level(env, env->current_level - 1);
       env->current_screen = GAME;
       return false;
     }
@@ -1465,8 +1601,7 @@ bool process_end(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
   }
 #else
   if (e->type == SDL_MOUSEBUTTONDOWN) {
-    SDL_Point mouse;
-    SDL_GetMouseState(&mouse.x, &mouse.y);
+    SDL_Point mouse = {e->button.x, e->button.y};
     // check if mouse is pressing one of the buttons
     // player presses restart button
     if ((w > h &&
@@ -1487,13 +1622,7 @@ bool process_end(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
              (w <= h &&
               (mouse.x > w * 1 / 3 && mouse.x < w * 2 / 3 &&
                mouse.y > h * 1 / 4 && mouse.y < h * 1 / 4 + h * 1 / 12))) {
-      game_delete(env->g);
-      env->games = dlist_prev(env->games);
-      env->current_level--;
-      char *level = dlist_data(env->games);
-      env->g = game_load(level);
-      create_level_text(win, ren, env);
-      create_tents_text(win, ren, env);
+      go_to_level(env, env->current_level - 1);
       env->current_screen = GAME;
       return false;
     }
@@ -1514,6 +1643,8 @@ bool process_end(SDL_Window *win, SDL_Renderer *ren, Env *env, SDL_Event *e) {
 
 void clean(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   /*Clean all the textures of the game */
+  load_lazy_textures(ren, env);  // they may not have been created yet
+  cancel_solving(env);
 
   SDL_DestroyTexture(env->home_screen);
   SDL_DestroyTexture(env->home_screen_vert);
@@ -1539,15 +1670,12 @@ void clean(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   SDL_DestroyTexture(env->solve);
   SDL_DestroyTexture(env->home_button);
   SDL_DestroyTexture(env->help_button_j);
-  SDL_DestroyTexture(env->current_level_text);
-
-  for (uint i = 0; i < env->max_game_cols_reached + env->max_game_rows_reached;
-       i++) {
-    SDL_DestroyTexture(env->text[i]);
+  glyph_atlas_delete(env->level_glyphs);
+  glyph_atlas_delete(env->label_glyphs);
+  glyph_atlas_delete(env->tents_glyphs);
+  if (env->static_layer != NULL) {
+    SDL_DestroyTexture(env->static_layer);
   }
-  free(env->text);
-  SDL_DestroyTexture(env->wrapping_text);
-  SDL_DestroyTexture(env->diagadj_text);
   SDL_DestroyTexture(env->switch_1);
   SDL_DestroyTexture(env->switch_2);
 
@@ -1560,68 +1688,202 @@ void clean(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   SDL_DestroyTexture(env->restart_game_over_button);
   SDL_DestroyTexture(env->quit_button);
 
-  while (dlist_next(env->games) != NULL) {
-    dlist_delete_after(env->games, env->games);
-  }
-  while (dlist_prev(env->games) != NULL) {
-    dlist_delete_before(env->games, env->games);
-  }
-  dlist_free(env->games);
+  level_pack_delete(env->levels);
+  solution_cache_close();
   game_delete(env->g);
   free(env);
 }
 /* **************************************************************** */
 
-bool mouse_is_in_grid(Env *env, int x, int y) {
-  if (x < env->grid_beginning_x ||
-      x > env->grid_beginning_x + env->cell_size * game_nb_cols(env->g) ||
-      y < env->grid_beginning_y ||
-      y > env->grid_beginning_y + env->cell_size * game_nb_rows(env->g)) {
+/* solves a copy of the game (run by the solving thread) */
+int solve_in_background(void *data) {
+  solve_job *job = (solve_job *)data;
+  job->status = game_solve_ext(job->g, &job->options);
+  if (job->status == SOLVE_TIMEOUT || job->status == SOLVE_NONE) {
+    // the grid is still given as far as it can be solved, even when it has no
+    // solution
+    job->options.time_limit = PARTIAL_TIME_LIMIT;
+    solve_status status = game_solve_partial(job->g, &job->options);
+    if (status == SOLVE_FOUND) {
+      job->status = SOLVE_FOUND;
+    } else {
+      job->partial = status != SOLVE_CANCELLED;
+    }
+  }
+  if (SDL_AtomicCAS(&job->state, JOB_RUNNING, JOB_DONE)) {
+    // wake the main loop up, it applies the solution (see finish_solving)
+    SDL_Event e;
+    memset(&e, 0, sizeof(e));
+    e.type = job->event;
+    SDL_PushEvent(&e);
+  } else {
+    // the solve was cancelled: nobody else will free the job
+    game_delete(job->g);
+    free(job);
+  }
+  return 0;
+}
+
+/* starts solving the current level in the background, from its trees */
+void start_solving(Env *env) {
+  solve_job *job = (solve_job *)malloc(sizeof(solve_job));
+  if (!job) ERROR("Not enough memory!\n");
+  job->g = game_copy(env->g);
+  game_restart(job->g);
+  job->status = SOLVE_NONE;
+  job->partial = false;
+  job->options.time_limit = SOLVE_TIME_LIMIT;
+  job->options.max_nodes = 0;
+  job->options.cancelled = 0;
+  job->event = env->solve_event;
+  SDL_AtomicSet(&job->state, JOB_RUNNING);
+  SDL_Thread *thread = SDL_CreateThread(solve_in_background, "solve", job);
+  if (!thread) ERROR("SDL_CreateThread: %s\n", SDL_GetError());
+  SDL_DetachThread(thread);
+  env->solving = job;
+  env->solving_since = SDL_GetTicks();
+}
+
+/* forgets the solve running in the background, if any */
+void cancel_solving(Env *env) {
+  if (env->solving == NULL) {
+    return;
+  }
+  // the search stops soon, instead of running until it is over; the job is
+  // still there, since the thread only frees it once it is cancelled
+  solve_cancel(&env->solving->options);
+  if (!SDL_AtomicCAS(&env->solving->state, JOB_RUNNING, JOB_CANCELLED)) {
+    // it is already over, so the thread won't free the job
+    game_delete(env->solving->g);
+    free(env->solving);
+  }
+  env->solving = NULL;
+}
+
+/* plays the solution found in the background (or the part of it that could
+ * be found) as a single move, once the solve is over */
+void finish_solving(Env *env) {
+  if (env->solving == NULL ||
+      SDL_AtomicGet(&env->solving->state) != JOB_DONE) {
+    return;
+  }
+  /* the time of the whole solve, partial pass included */
+  double elapsed = (SDL_GetTicks() - env->solving_since) / 1000.0;
+  if (env->solving->status == SOLVE_FOUND) {
+    game_play_solution(env->g, env->solving->g);
+  } else if (env->solving->partial) {
+    game_play_solution(env->g, env->solving->g);
+    if (env->solving->status == SOLVE_NONE) {
+      PRINT("The level has no solution (%.1f s), it is only solved in part\n",
+            elapsed);
+    } else {
+      PRINT("No solution found in %.1f s, the grid is only solved in part\n",
+            elapsed);
+    }
+  } else if (env->solving->status == SOLVE_TIMEOUT) {
+    PRINT("No solution found in %.1f s, the solve was given up\n", elapsed);
+  } else if (env->solving->status == SOLVE_NONE) {
+    PRINT("The level has no solution (%.1f s)\n", elapsed);
+  }
+  game_delete(env->solving->g);
+  free(env->solving);
+  env->solving = NULL;
+  env->dirty = true;
+}
+
+/* gives the cell of the grid at a position of the window, if there is one in
+ * view */
+bool cell_at(Env *env, int x, int y, uint *row, uint *col) {
+  if (x < env->view.x || x >= env->view.x + env->view.w ||
+      y < env->view.y || y >= env->view.y + env->view.h) {
     return false;
   }
-  return true;
+  *row = (uint)(y - env->view.y + env->pan_y) / env->view_cell_size;
+  *col = (uint)(x - env->view.x + env->pan_x) / env->view_cell_size;
+  return *row < game_nb_rows(env->g) && *col < game_nb_cols(env->g);
 }
 
-void create_tents_text(SDL_Window *win, SDL_Renderer *ren, Env *env) {
-  int w, h;
-  SDL_GetWindowSize(win, &w, &h);
-  SDL_Color color = TEXT_COLOR; /* blue color in RGBA */
-  TTF_Font *font = TTF_OpenFont(FONT, w);
-  if (!font) ERROR("TTF_OpenFont: %s\n", FONT);
-  TTF_SetFontStyle(font, TTF_STYLE_BOLD);
-  char text_tents[2];
-  for (uint i = 0; i < game_nb_rows(env->g); i++) {
-    sprintf(text_tents, "%u", game_get_expected_nb_tents_row(env->g, i));
-    SDL_Surface *surf = TTF_RenderText_Blended(
-        font, text_tents, color);  // blended rendering for ultra nice text
-    env->text[i] = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
+/* replaces the game by a copy of a level of the pack */
+void go_to_level(Env *env, uint level) {
+  game_delete(env->g);
+  env->current_level = level;
+  env->g = game_copy(level_pack_get(env->levels, level - 1));
+  level_changed(env);
+}
+
+/* shows the whole grid of a new level, and drops the solve of the previous
+ * one */
+void level_changed(Env *env) {
+  cancel_solving(env);
+  game_track_losing_squares(env->g); /* read by render_game on each frame */
+  env->zoom = 1;
+  env->pan_x = 0;
+  env->pan_y = 0;
+  env->static_layer_up_to_date = false;
+}
+
+/* computes the part of the window where the grid is shown, and keeps the zoom
+ * and the scrolling in their bounds */
+void update_view(Env *env) {
+  uint nb_rows = game_nb_rows(env->g);
+  uint nb_cols = game_nb_cols(env->g);
+  // the grid and its numbers of tents fill the same space at any zoom, and
+  // at least two cells stay in view
+  int content_w = env->cell_size * (nb_cols + 1);
+  int content_h = env->cell_size * (nb_rows + 1);
+  int max_size = (content_w < content_h ? content_w : content_h) / 3;
+  if (env->zoom * env->cell_size > max_size) {
+    env->zoom = (float)max_size / env->cell_size;
   }
-  for (uint j = 0; j < game_nb_cols(env->g); j++) {
-    sprintf(text_tents, "%u", game_get_expected_nb_tents_col(env->g, j));
-    SDL_Surface *surf = TTF_RenderText_Blended(
-        font, text_tents, color);  // blended rendering for ultra nice text
-    env->text[game_nb_rows(env->g) + j] =
-        SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
+  if (env->zoom < 1) {
+    env->zoom = 1;
   }
-  TTF_CloseFont(font);
+  env->view_cell_size = (int)(env->cell_size * env->zoom);
+  env->view.x = env->grid_beginning_x;
+  env->view.y = env->grid_beginning_y;
+  env->view.w = content_w - env->view_cell_size;
+  env->view.h = content_h - env->view_cell_size;
+  int max_pan_x = env->view_cell_size * nb_cols - env->view.w;
+  int max_pan_y = env->view_cell_size * nb_rows - env->view.h;
+  env->pan_x = env->pan_x > max_pan_x ? max_pan_x : env->pan_x;
+  env->pan_y = env->pan_y > max_pan_y ? max_pan_y : env->pan_y;
+  env->pan_x = env->pan_x < 0 ? 0 : env->pan_x;
+  env->pan_y = env->pan_y < 0 ? 0 : env->pan_y;
 }
 
-void create_level_text(SDL_Window *win, SDL_Renderer *ren, Env *env) {
-  int w, h;
-  SDL_GetWindowSize(win, &w, &h);
-  SDL_Rect rect;
-  int font_size = (int)(h * ABOVE_GRID_RATIO * 1 / 3);
-  SDL_Color color = TEXT_COLOR;
-  TTF_Font *font = TTF_OpenFont(FONT_LEVEL, font_size);
-  if (!font) ERROR("TTF_OpenFont: %s\n", FONT_LEVEL);
-  TTF_SetFontStyle(font, TTF_STYLE_NORMAL);
-  char level_text[10];
-  sprintf(level_text, "LEVEL %u", env->current_level);
-  SDL_Surface *surf = TTF_RenderText_Blended(font, level_text, color);
-  env->current_level_text = SDL_CreateTextureFromSurface(ren, surf);
-  TTF_CloseFont(font);
-  SDL_QueryTexture(env->current_level_text, NULL, NULL, &rect.w, &rect.h);
-  env->level_ratio = rect.w / rect.h;
-}
\ No newline at end of file
+/* zooms the grid in (factor > 1) or out around a point of the window */
+void zoom_view(Env *env, float factor, int x, int y) {
+  // the point of the grid under (x, y) stays there
+  float cell_x = (float)(x - env->view.x + env->pan_x) / env->view_cell_size;
+  float cell_y = (float)(y - env->view.y + env->pan_y) / env->view_cell_size;
+  env->zoom *= factor;
+  update_view(env);
+  env->pan_x = (int)(cell_x * env->view_cell_size) - (x - env->view.x);
+  env->pan_y = (int)(cell_y * env->view_cell_size) - (y - env->view.y);
+  update_view(env);
+  env->static_layer_up_to_date = false;
+}
+
+/* scrolls the zoomed grid by some pixels */
+void pan_view(Env *env, int dx, int dy) {
+  env->pan_x += dx;
+  env->pan_y += dy;
+  update_view(env);
+  env->static_layer_up_to_date = false;
+}
+
+/* gives the rows and columns (end excluded) that are at least partly in view */
+void visible_cells(Env *env, uint *first_row, uint *end_row, uint *first_col,
+                   uint *end_col) {
+  int size = env->view_cell_size;
+  *first_row = env->pan_y / size;
+  *first_col = env->pan_x / size;
+  *end_row = (env->pan_y + env->view.h + size - 1) / size;
+  *end_col = (env->pan_x + env->view.w + size - 1) / size;
+  if (*end_row > game_nb_rows(env->g)) {
+    *end_row = game_nb_rows(env->g);
+  }
+  if (*end_col > game_nb_cols(env->g)) {
+    *end_col = game_nb_cols(env->g);
+  }
+}
@@ -29,7 +29,9 @@ typedef struct Env_t Env;
 #define APP_NAME "Tents - A62E"
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
-#define DELAY 100
+#define WAIT_TIMEOUT 500 /* ms, the main loop wakes up at least this often */
+#define FRAME_TIMEOUT 33 /* ms, the same while a solve runs, to animate it */
+#define DOTS_PERIOD 250  /* ms, between two steps of the solving indicator */
 
 /* **************************************************************** */
 
@@ -37,6 +39,9 @@ Env * init(SDL_Window* win, SDL_Renderer* ren, int argc, char* argv[]);
 void render(SDL_Window* win, SDL_Renderer* ren, Env * env);
 void clean(SDL_Window* win, SDL_Renderer* ren, Env * env);
 bool process(SDL_Window* win, SDL_Renderer* ren, Env * env, SDL_Event * e);
+bool needs_render(Env * env); /* true if something changed since the last render */
+Uint32 wait_timeout(Env * env); /* ms the main loop may sleep before rendering again */
+bool cell_center(Env * env, uint row, uint col, int * x, int * y); /* center of a cell in the last rendered frame, false if it isn't in view */
 
 /* **************************************************************** */
 
@@ -0,0 +1,173 @@
+#include "level_pack.h"
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "game_tools.h"
+#include "graphic_mode.h"
+
+enum {
+  MAX_LOADING_THREADS = 8 /**< at most this many files are read at once */
+};
+
+struct level_pack_s {
+  uint nb_files;
+  char **files;
+  game *games;            /**< game of each file, NULL if it isn't valid */
+  SDL_atomic_t next_file; /**< next file to be loaded by a thread */
+  uint nb_threads;
+  SDL_Thread *threads[MAX_LOADING_THREADS];
+  bool loaded; /**< true once the threads are over */
+  uint nb_levels;
+  game *levels; /**< the valid games, in the order of the files */
+};
+
+// Declaration of the functions that aren't given in the .h files
+#ifdef __ANDROID__
+static void copy_asset(char *src, char *dst);
+#endif
+static game load_level(char *file);
+static int load_files(void *data);
+static void wait_loaded(level_pack *p);
+
+#ifdef __ANDROID__
+void copy_asset(char *src, char *dst) {
+  SDL_RWops *file = SDL_RWFromFile(src, "r");
+  if (!file) ERROR("[ERROR] SDL_RWFromFile: %s\n", src);
+  int size = SDL_RWsize(file);
+  PRINT("copy file %s (%d bytes) into %s\n", src, size, dst);
+  char *buf = (char *)malloc(size + 1);
+  if (!buf) ERROR("[ERROR] malloc\n");
+  int r = SDL_RWread(file, buf, 1, size);
+  PRINT("read %d\n", r);
+  if (r != size) ERROR("[ERROR] fail to read all file (%d bytes)\n", r);
+  FILE *out = fopen(dst, "w+");
+  if (!out) ERROR("[ERROR] fail to create file %s\n", dst);
+  int w = fwrite(buf, 1, r, out);
+  if (r != w) ERROR("[ERROR] fail to write all file (%d bytes)\n", w);
+  fclose(out);
+  SDL_RWclose(file);
+  free(buf);
+}
+#endif
+
+/**
+ * @brief Reads a level file
+ * @param file the name of the file (on Android, the name of the asset)
+ * @return the game
+ **/
+game load_level(char *file) {
+#ifdef __ANDROID__
+  // the asset is copied out of the package, to be read by game_load
+  const char *dir = SDL_AndroidGetInternalStoragePath();
+  char filename[1024];
+  sprintf(filename, "%s/%s", dir, file);
+  copy_asset(file, filename);
+  return game_load(filename);
+#else
+  return game_load(file);
+#endif
+}
+
+/**
+ * @brief Loads and checks the files of a pack, until there are none left
+ * (run by each loading thread)
+ * @param data the pack
+ * @return 0
+ **/
+int load_files(void *data) {
+  level_pack *p = (level_pack *)data;
+  int k;
+  while ((k = SDL_AtomicAdd(&p->next_file, 1)) < (int)p->nb_files) {
+    game g = load_level(p->files[k]);
+    // the level must be solvable from its trees alone
+    game solution = game_copy(g);
+    game_restart(solution);
+    if (!game_solve(solution)) {
+      PRINT("Level %s has no solution, it is left out\n", p->files[k]);
+      game_delete(g);
+      g = NULL;
+    }
+    game_delete(solution);
+    p->games[k] = g;
+  }
+  return 0;
+}
+
+/**
+ * @brief Waits for the loading threads, and keeps the valid levels
+ * @param p the pack
+ **/
+void wait_loaded(level_pack *p) {
+  if (p->loaded) {
+    return;
+  }
+  for (uint t = 0; t < p->nb_threads; t++) {
+    SDL_WaitThread(p->threads[t], NULL);
+  }
+  p->nb_levels = 0;
+  for (uint k = 0; k < p->nb_files; k++) {
+    if (p->games[k] != NULL) {
+      p->levels[p->nb_levels] = p->games[k];
+      p->nb_levels++;
+    }
+  }
+  p->loaded = true;
+}
+
+level_pack *level_pack_load(uint nb_files, char *files[]) {
+  level_pack *p = (level_pack *)malloc(sizeof(level_pack));
+  if (!p) ERROR("Not enough memory!\n");
+  p->nb_files = nb_files;
+  p->files = (char **)malloc(sizeof(char *) * (nb_files + 1));
+  p->games = (game *)malloc(sizeof(game) * (nb_files + 1));
+  p->levels = (game *)malloc(sizeof(game) * (nb_files + 1));
+  if (!p->files || !p->games || !p->levels) ERROR("Not enough memory!\n");
+  for (uint k = 0; k < nb_files; k++) {
+    p->files[k] = files[k];
+    p->games[k] = NULL;
+  }
+  SDL_AtomicSet(&p->next_file, 0);
+  p->loaded = false;
+  p->nb_levels = 0;
+
+  // one thread per processor, but no more than there are files
+  int nb_cpus = SDL_GetCPUCount();
+  p->nb_threads = nb_cpus < 1 ? 1 : (uint)nb_cpus;
+  if (p->nb_threads > MAX_LOADING_THREADS) {
+    p->nb_threads = MAX_LOADING_THREADS;
+  }
+  if (p->nb_threads > nb_files) {
+    p->nb_threads = nb_files;
+  }
+  for (uint t = 0; t < p->nb_threads; t++) {
+    p->threads[t] = SDL_CreateThread(load_files, "load_levels", p);
+    if (!p->threads[t]) ERROR("SDL_CreateThread: %s\n", SDL_GetError());
+  }
+  return p;
+}
+
+uint level_pack_size(level_pack *p) {
+  wait_loaded(p);
+  return p->nb_levels;
+}
+
+cgame level_pack_get(level_pack *p, uint k) {
+  wait_loaded(p);
+  if (k >= p->nb_levels) ERROR("There is no level %u in the pack\n", k);
+  return p->levels[k];
+}
+
+void level_pack_delete(level_pack *p) {
+  if (p == NULL) {
+    return;
+  }
+  wait_loaded(p);
+  for (uint k = 0; k < p->nb_files; k++) {
+    game_delete(p->games[k]);
+  }
+  free(p->files);
+  free(p->games);
+  free(p->levels);
+  free(p);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file level_pack.h
+ * @brief Levels of the SDL front-end, loaded once in memory.
+ * @details The level files are read and checked with the solver by a few
+ * threads, while the home screen is shown. Once the pack is loaded, going
+ * from a level to another one never touches the disk.
+ *
+ **/
+
+#ifndef __LEVEL_PACK_H__
+#define __LEVEL_PACK_H__
+#include "game.h"
+
+/**
+ * @brief The pack of levels, see @ref level_pack_load.
+ **/
+typedef struct level_pack_s level_pack;
+
+/**
+ * @brief Starts loading the levels of a pack in the background
+ * @details The levels that can't be solved are left out of the pack (with a
+ * message), so the pack may hold fewer levels than there are files.
+ * @param nb_files the number of level files
+ * @param files the names of the level files, in the order of the levels
+ * (on Android, the names of the assets)
+ * @return the pack
+ **/
+level_pack *level_pack_load(uint nb_files, char *files[]);
+
+/**
+ * @brief Gives the number of levels of a pack
+ * @details Waits for the pack to be loaded if it isn't yet.
+ * @param p the pack
+ * @return the number of valid levels
+ **/
+uint level_pack_size(level_pack *p);
+
+/**
+ * @brief Gives a level of a pack
+ * @details Waits for the pack to be loaded if it isn't yet. The level belongs
+ * to the pack: play on a copy of it.
+ * @param p the pack
+ * @param k the index of the level, from 0
+ * @return the level
+ * @pre @p k < level_pack_size(p)
+ **/
+cgame level_pack_get(level_pack *p, uint k);
+
+/**
+ * @brief Deletes a pack and its levels
+ * @param p the pack
+ **/
+void level_pack_delete(level_pack *p);
+
+#endif  // __LEVEL_PACK_H__
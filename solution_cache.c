@@ -0,0 +1,538 @@
+#include "solution_cache.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "extra_functions.h"
+#include "game.h"
+#include "game_ext.h"
+
+#define CACHE_MAGIC "TENTS-SOLUTIONS-1\n"
+
+enum {
+  MAGIC_SIZE = sizeof(CACHE_MAGIC) - 1,
+  MIN_CAPACITY = 64,       /**< initial number of slots of the hash table */
+  MAX_SQUARES = 1 << 24,   /**< bigger records are taken for garbage */
+};
+
+/**
+ * @brief Header of a record of the file, followed by the nb_rows + nb_cols
+ * numbers of tents (as uint32_t) and by the nb_rows * nb_cols squares (one
+ * byte each). A record gives everything that is known of a puzzle, so the
+ * last record of a puzzle replaces the previous ones.
+ **/
+typedef struct {
+  uint32_t nb_rows;
+  uint32_t nb_cols;
+  uint8_t wrapping;
+  uint8_t diagadj;
+  uint8_t has_solution; /**< 0 if the squares are only the trees */
+  uint8_t unused;
+  uint32_t nb_solutions; /**< SOLUTION_CACHE_UNKNOWN if not counted */
+} record;
+
+/**
+ * @brief A puzzle of the cache.
+ **/
+typedef struct {
+  uint64_t hash;
+  record header;
+  uint32_t *clues;        /**< row clues, then column clues */
+  unsigned char *squares; /**< the solution, or only the trees */
+} entry;
+
+/**
+ * @brief A puzzle in its canonical orientation, ready to be looked for.
+ * @details It is computed before the cache is locked, since finding the
+ * canonical orientation of a game is the costly part of a lookup.
+ **/
+struct solution_cache_key_s {
+  game_symmetry sym;      /**< from the game to the canonical orientation */
+  record header;          /**< size and options, nothing known of it */
+  uint32_t *clues;        /**< row clues, then column clues */
+  unsigned char *squares; /**< the squares, in the canonical orientation */
+  uint64_t hash;
+};
+
+/**
+ * @brief The cache: the log file and its hash table (open addressing).
+ **/
+typedef struct {
+  FILE *log;
+  entry **table; /**< capacity slots, NULL when empty */
+  size_t capacity;
+  size_t nb_entries;
+} cache;
+
+// Declaration of the functions that aren't given in the .h files
+static uint64_t record_hash(const record *header, const uint32_t *clues,
+                            const unsigned char *squares);
+static void puzzle_of_game(cgame g, game_symmetry sym, record *header,
+                           uint32_t *clues, unsigned char *squares);
+static bool same_puzzle(const entry *e, const record *header,
+                        const uint32_t *clues, const unsigned char *squares);
+static entry **find_slot(cache *c, uint64_t hash, const record *header,
+                         const uint32_t *clues, const unsigned char *squares);
+static bool cache_is_open(void);
+static void grow(cache *c);
+static entry *merge(cache *c, uint64_t hash, const record *header,
+                    const uint32_t *clues, const unsigned char *squares,
+                    bool *p_changed);
+static void write_record(cache *c, const entry *e);
+static void read_log(cache *c);
+static void delete_cache(cache *c);
+
+static cache *opened = NULL; /* the cache used by the solver, if any */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER; /* guards opened */
+
+/**
+ * @brief Hashes a puzzle of the cache, like game_canonical_hash does for the
+ * canonical puzzle of a game
+ * @param header the size and options
+ * @param clues the numbers of tents
+ * @param squares the squares, only the trees are looked at
+ * @return the hash
+ **/
+uint64_t record_hash(const record *header, const uint32_t *clues,
+                     const unsigned char *squares) {
+  return puzzle_hash(header->nb_rows, header->nb_cols, header->wrapping,
+                     header->diagadj, clues, squares);
+}
+
+/**
+ * @brief Reads the puzzle of a game, in the orientation given by a symmetry
+ * @details The puzzles are stored in their canonical orientation (see
+ * game_canonical_symmetry), so that the games that are symmetric to each
+ * other share their entry.
+ * @param g the game
+ * @param sym the symmetry
+ * @param header receives the size and options (nothing is known yet)
+ * @param clues receives the numbers of tents, or NULL
+ * @param squares receives the squares of the game
+ **/
+void puzzle_of_game(cgame g, game_symmetry sym, record *header,
+                    uint32_t *clues, unsigned char *squares) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  memset(header, 0, sizeof(record));
+  header->nb_rows = sym.transpose ? nb_cols : nb_rows;
+  header->nb_cols = sym.transpose ? nb_rows : nb_cols;
+  header->wrapping = game_is_wrapping(g);
+  header->diagadj = game_is_diagadj(g);
+  header->nb_solutions = SOLUTION_CACHE_UNKNOWN;
+  for (uint i = 0; i < nb_rows; i++) {
+    const unsigned char *row = game_row_squares(g, i);
+    for (uint j = 0; j < nb_cols; j++) {
+      uint sym_i, sym_j;
+      game_symmetry_cell(g, sym, i, j, &sym_i, &sym_j);
+      squares[sym_i * header->nb_cols + sym_j] = row[j];
+      // the clues of the row and of the column move with their first cell
+      if (clues == NULL) {
+        continue;
+      }
+      if (j == 0) {
+        clues[sym.transpose ? header->nb_rows + sym_j : sym_i] =
+            game_get_expected_nb_tents_row(g, i);
+      }
+      if (i == 0) {
+        clues[sym.transpose ? sym_i : header->nb_rows + sym_j] =
+            game_get_expected_nb_tents_col(g, j);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Tells if an entry is the given puzzle
+ * @param e the entry
+ * @param header the size and options of the puzzle
+ * @param clues the numbers of tents of the puzzle
+ * @param squares the squares of the puzzle, only the trees are looked at
+ * @return true if they are the same
+ **/
+bool same_puzzle(const entry *e, const record *header, const uint32_t *clues,
+                 const unsigned char *squares) {
+  if (e->header.nb_rows != header->nb_rows ||
+      e->header.nb_cols != header->nb_cols ||
+      e->header.wrapping != header->wrapping ||
+      e->header.diagadj != header->diagadj ||
+      memcmp(e->clues, clues,
+             sizeof(uint32_t) * (header->nb_rows + header->nb_cols)) != 0) {
+    return false;
+  }
+  size_t nb_squares = (size_t)header->nb_rows * header->nb_cols;
+  for (size_t k = 0; k < nb_squares; k++) {
+    if ((e->squares[k] == TREE) != (squares[k] == TREE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the slot of a puzzle in the hash table
+ * @param c the cache
+ * @param hash the hash of the puzzle
+ * @param header the size and options of the puzzle
+ * @param clues the numbers of tents of the puzzle
+ * @param squares the squares of the puzzle
+ * @return the slot of its entry, or the empty slot where it would go
+ **/
+entry **find_slot(cache *c, uint64_t hash, const record *header,
+                  const uint32_t *clues, const unsigned char *squares) {
+  size_t k = (size_t)hash & (c->capacity - 1);
+  while (c->table[k] != NULL &&
+         (c->table[k]->hash != hash ||
+          !same_puzzle(c->table[k], header, clues, squares))) {
+    k = (k + 1) & (c->capacity - 1);
+  }
+  return &c->table[k];
+}
+
+/**
+ * @brief Tells if a cache is opened
+ * @details When none is, the games don't have to be turned into puzzles.
+ * @return true if a cache is opened
+ **/
+bool cache_is_open(void) {
+  pthread_mutex_lock(&lock);
+  bool is_open = opened != NULL;
+  pthread_mutex_unlock(&lock);
+  return is_open;
+}
+
+/**
+ * @brief Doubles the number of slots of the hash table
+ * @param c the cache
+ **/
+void grow(cache *c) {
+  entry **old_table = c->table;
+  size_t old_capacity = c->capacity;
+  c->capacity = old_capacity * 2;
+  c->table = (entry **)calloc(c->capacity, sizeof(entry *));
+  if (c->table == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t k = 0; k < old_capacity; k++) {
+    entry *e = old_table[k];
+    if (e != NULL) {
+      *find_slot(c, e->hash, &e->header, e->clues, e->squares) = e;
+    }
+  }
+  free(old_table);
+}
+
+/**
+ * @brief Adds what is known of a puzzle to the hash table
+ * @param c the cache
+ * @param hash the hash of the puzzle
+ * @param header the size and options of the puzzle, with what is known of it
+ * @param clues the numbers of tents of the puzzle
+ * @param squares its solution if header->has_solution, only its trees are
+ * looked at otherwise
+ * @param p_changed receives true if the entry of the puzzle learned something
+ * @return the entry of the puzzle
+ **/
+entry *merge(cache *c, uint64_t hash, const record *header,
+             const uint32_t *clues, const unsigned char *squares,
+             bool *p_changed) {
+  entry **slot = find_slot(c, hash, header, clues, squares);
+  entry *e = *slot;
+  size_t nb_clues = header->nb_rows + header->nb_cols;
+  size_t nb_squares = (size_t)header->nb_rows * header->nb_cols;
+  *p_changed = false;
+  if (e == NULL) {
+    // the entry and its arrays are one block
+    e = (entry *)malloc(sizeof(entry) + sizeof(uint32_t) * nb_clues +
+                        nb_squares);
+    if (e == NULL) {
+      fprintf(stderr, "Not enough memory!\n");
+      exit(EXIT_FAILURE);
+    }
+    e->hash = hash;
+    e->header = *header;
+    e->header.has_solution = 0;
+    e->header.nb_solutions = SOLUTION_CACHE_UNKNOWN;
+    e->clues = (uint32_t *)(e + 1);
+    e->squares = (unsigned char *)(e->clues + nb_clues);
+    memcpy(e->clues, clues, sizeof(uint32_t) * nb_clues);
+    for (size_t k = 0; k < nb_squares; k++) {
+      e->squares[k] = squares[k] == TREE ? TREE : EMPTY;
+    }
+    *slot = e;
+    c->nb_entries++;
+    *p_changed = true;
+    if (c->nb_entries * 4 > c->capacity * 3) {
+      grow(c);
+    }
+  }
+  if (header->has_solution && !e->header.has_solution) {
+    memcpy(e->squares, squares, nb_squares);
+    e->header.has_solution = 1;
+    *p_changed = true;
+  }
+  if (header->nb_solutions != SOLUTION_CACHE_UNKNOWN &&
+      header->nb_solutions != e->header.nb_solutions) {
+    e->header.nb_solutions = header->nb_solutions;
+    *p_changed = true;
+  }
+  return e;
+}
+
+/**
+ * @brief Appends the record of an entry to the log
+ * @param c the cache
+ * @param e the entry
+ **/
+void write_record(cache *c, const entry *e) {
+  size_t nb_clues = e->header.nb_rows + e->header.nb_cols;
+  size_t nb_squares = (size_t)e->header.nb_rows * e->header.nb_cols;
+  fwrite(&e->header, sizeof(record), 1, c->log);
+  fwrite(e->clues, sizeof(uint32_t), nb_clues, c->log);
+  fwrite(e->squares, 1, nb_squares, c->log);
+  fflush(c->log);
+}
+
+/**
+ * @brief Reads the records of the log into the hash table
+ * @details The reading stops at the first record that isn't complete (the
+ * program may have been stopped while writing it), and the next records are
+ * written over it.
+ * @param c the cache, whose log is positioned after the magic string
+ **/
+void read_log(cache *c) {
+  long end = ftell(c->log);
+  record header;
+  while (fread(&header, sizeof(record), 1, c->log) == 1) {
+    size_t nb_clues = (size_t)header.nb_rows + header.nb_cols;
+    size_t nb_squares = (size_t)header.nb_rows * header.nb_cols;
+    if (header.nb_rows == 0 || header.nb_cols == 0 ||
+        header.nb_rows > MAX_SQUARES / header.nb_cols) {
+      break;
+    }
+    uint32_t *clues = (uint32_t *)malloc(sizeof(uint32_t) * nb_clues);
+    unsigned char *squares = (unsigned char *)malloc(nb_squares);
+    if (clues == NULL || squares == NULL) {
+      fprintf(stderr, "Not enough memory!\n");
+      exit(EXIT_FAILURE);
+    }
+    bool complete = fread(clues, sizeof(uint32_t), nb_clues, c->log) ==
+                        nb_clues &&
+                    fread(squares, 1, nb_squares, c->log) == nb_squares;
+    if (complete) {
+      bool changed;
+      merge(c, record_hash(&header, clues, squares), &header, clues, squares,
+            &changed);
+      end = ftell(c->log);
+    }
+    free(clues);
+    free(squares);
+    if (!complete) {
+      break;
+    }
+  }
+  fseek(c->log, end, SEEK_SET);
+}
+
+/**
+ * @brief Closes the log of a cache and frees it
+ * @param c the cache
+ **/
+void delete_cache(cache *c) {
+  if (c == NULL) {
+    return;
+  }
+  for (size_t k = 0; k < c->capacity; k++) {
+    free(c->table[k]);
+  }
+  free(c->table);
+  if (c->log != NULL) {
+    fclose(c->log);
+  }
+  free(c);
+}
+
+bool solution_cache_open(const char *filename) {
+  solution_cache_close();
+  cache *c = (cache *)malloc(sizeof(cache));
+  if (c == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  c->capacity = MIN_CAPACITY;
+  c->nb_entries = 0;
+  c->table = (entry **)calloc(c->capacity, sizeof(entry *));
+  if (c->table == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  c->log = fopen(filename, "r+b");
+  if (c->log == NULL) {
+    c->log = fopen(filename, "w+b");
+    if (c->log == NULL) {
+      delete_cache(c);
+      return false;
+    }
+  }
+  char magic[MAGIC_SIZE];
+  size_t nb_read = fread(magic, 1, MAGIC_SIZE, c->log);
+  if (nb_read == MAGIC_SIZE && memcmp(magic, CACHE_MAGIC, MAGIC_SIZE) == 0) {
+    read_log(c);
+  } else if (nb_read == 0) {
+    // a new file
+    fseek(c->log, 0, SEEK_SET);
+    fwrite(CACHE_MAGIC, 1, MAGIC_SIZE, c->log);
+    fflush(c->log);
+  } else {
+    fprintf(stderr, "%s isn't a solution cache!\n", filename);
+    delete_cache(c);
+    return false;
+  }
+  pthread_mutex_lock(&lock);
+  opened = c;
+  pthread_mutex_unlock(&lock);
+  return true;
+}
+
+void solution_cache_close(void) {
+  pthread_mutex_lock(&lock);
+  cache *c = opened;
+  opened = NULL;
+  pthread_mutex_unlock(&lock);
+  delete_cache(c);
+}
+
+solution_cache_key solution_cache_key_new(cgame g) {
+  test_pointer(g);
+  if (!cache_is_open()) {
+    return NULL;
+  }
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  solution_cache_key key =
+      (solution_cache_key)malloc(sizeof(struct solution_cache_key_s));
+  if (key == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  key->clues = (uint32_t *)malloc(sizeof(uint32_t) * (nb_rows + nb_cols));
+  key->squares = (unsigned char *)malloc((size_t)nb_rows * nb_cols);
+  if (key->clues == NULL || key->squares == NULL) {
+    fprintf(stderr, "Not enough memory!\n");
+    exit(EXIT_FAILURE);
+  }
+  key->sym = game_canonical_symmetry(g);
+  puzzle_of_game(g, key->sym, &key->header, key->clues, key->squares);
+  key->hash = record_hash(&key->header, key->clues, key->squares);
+  return key;
+}
+
+void solution_cache_key_delete(solution_cache_key key) {
+  if (key == NULL) {
+    return;
+  }
+  free(key->clues);
+  free(key->squares);
+  free(key);
+}
+
+bool solution_cache_key_solution(solution_cache_key key, cgame g,
+                                 unsigned char *squares) {
+  test_pointer(g);
+  if (key == NULL) {
+    return false;
+  }
+  bool found = false;
+  pthread_mutex_lock(&lock);
+  if (opened != NULL) {
+    entry *e = *find_slot(opened, key->hash, &key->header, key->clues,
+                          key->squares);
+    if (e != NULL && e->header.has_solution) {
+      uint nb_cols = game_nb_cols(g);
+      for (uint i = 0; i < game_nb_rows(g); i++) {
+        for (uint j = 0; j < nb_cols; j++) {
+          uint sym_i, sym_j;
+          game_symmetry_cell(g, key->sym, i, j, &sym_i, &sym_j);
+          squares[i * nb_cols + j] =
+              e->squares[sym_i * e->header.nb_cols + sym_j];
+        }
+      }
+      found = true;
+    }
+  }
+  pthread_mutex_unlock(&lock);
+  return found;
+}
+
+uint solution_cache_key_nb_solutions(solution_cache_key key) {
+  if (key == NULL) {
+    return SOLUTION_CACHE_UNKNOWN;
+  }
+  uint nb_solutions = SOLUTION_CACHE_UNKNOWN;
+  pthread_mutex_lock(&lock);
+  if (opened != NULL) {
+    entry *e = *find_slot(opened, key->hash, &key->header, key->clues,
+                          key->squares);
+    if (e != NULL) {
+      nb_solutions = e->header.nb_solutions;
+    }
+  }
+  pthread_mutex_unlock(&lock);
+  return nb_solutions;
+}
+
+void solution_cache_key_add(solution_cache_key key, cgame solution,
+                            uint nb_solutions) {
+  if (key == NULL) {
+    return;
+  }
+  record header = key->header;
+  header.has_solution = solution != NULL;
+  header.nb_solutions = nb_solutions;
+  unsigned char *squares = key->squares;
+  if (solution != NULL) {
+    // the solution has the trees of the puzzle, so it is turned the same way
+    squares = (unsigned char *)malloc((size_t)header.nb_rows * header.nb_cols);
+    if (squares == NULL) {
+      fprintf(stderr, "Not enough memory!\n");
+      exit(EXIT_FAILURE);
+    }
+    record solution_header;
+    puzzle_of_game(solution, key->sym, &solution_header, NULL, squares);
+  }
+  pthread_mutex_lock(&lock);
+  if (opened != NULL) {
+    bool changed;
+    entry *e =
+        merge(opened, key->hash, &header, key->clues, squares, &changed);
+    if (changed) {
+      write_record(opened, e);
+    }
+  }
+  pthread_mutex_unlock(&lock);
+  if (squares != key->squares) {
+    free(squares);
+  }
+}
+
+bool solution_cache_solution(cgame g, unsigned char *squares) {
+  solution_cache_key key = solution_cache_key_new(g);
+  bool found = solution_cache_key_solution(key, g, squares);
+  solution_cache_key_delete(key);
+  return found;
+}
+
+uint solution_cache_nb_solutions(cgame g) {
+  solution_cache_key key = solution_cache_key_new(g);
+  uint nb_solutions = solution_cache_key_nb_solutions(key);
+  solution_cache_key_delete(key);
+  return nb_solutions;
+}
+
+void solution_cache_add(cgame g, cgame solution, uint nb_solutions) {
+  solution_cache_key key = solution_cache_key_new(g);
+  solution_cache_key_add(key, solution, nb_solutions);
+  solution_cache_key_delete(key);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file solution_cache.h
+ * @brief Cache of the solutions of the puzzles, kept in a file.
+ * @details Once a cache is opened, game_solve and game_nb_solutions look for
+ * the puzzle in it before searching, and record what they find. A puzzle is
+ * identified by its size, its options, its numbers of tents and its trees (the
+ * tents and grass that are already played aren't part of it), up to the
+ * symmetries of the grid: a puzzle that has been solved is also known turned
+ * or reflected.
+ *
+ * The file is a log: the records are only ever appended to it, and it is read
+ * once, when it is opened, into a hash table. The cache can be used by
+ * several threads at once.
+ *
+ **/
+
+#ifndef __SOLUTION_CACHE_H__
+#define __SOLUTION_CACHE_H__
+#include <limits.h>
+#include <stdbool.h>
+#include "game.h"
+
+/**
+ * @brief Number of solutions of a puzzle that hasn't been counted yet.
+ **/
+#define SOLUTION_CACHE_UNKNOWN UINT_MAX
+
+/**
+ * @brief The puzzle of a game, in its canonical orientation, ready to be
+ * looked for in the cache.
+ * @details Finding the canonical orientation of a game is the costly part of
+ * a lookup, so a solver that looks a puzzle up and then records it makes the
+ * key once and uses it for both.
+ **/
+typedef struct solution_cache_key_s *solution_cache_key;
+
+/**
+ * @brief Opens a cache file, and makes game_solve and game_nb_solutions use it
+ * @details The file is created if it doesn't exist. A cache that was already
+ * opened is closed first.
+ * @param filename the name of the file
+ * @return true if the file could be opened, false otherwise (no cache is then
+ * used)
+ **/
+bool solution_cache_open(const char *filename);
+
+/**
+ * @brief Closes the cache, the games are then solved without it
+ **/
+void solution_cache_close(void);
+
+/**
+ * @brief Gives the cached solution of the puzzle of a game
+ * @param g the game
+ * @param squares receives the game_nb_rows(g) * game_nb_cols(g) squares of
+ * the solution, in row-major order, if there is one in the cache
+ * @return true if the cache has a solution of the puzzle
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool solution_cache_solution(cgame g, unsigned char *squares);
+
+/**
+ * @brief Gives the cached number of solutions of the puzzle of a game
+ * @param g the game
+ * @return the number of solutions, or SOLUTION_CACHE_UNKNOWN
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+uint solution_cache_nb_solutions(cgame g);
+
+/**
+ * @brief Records what is known of the puzzle of a game
+ * @details Nothing is written if the cache already knew it.
+ * @param g the game
+ * @param solution a solution of the puzzle, or NULL if it isn't known
+ * @param nb_solutions the number of solutions, or SOLUTION_CACHE_UNKNOWN
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+void solution_cache_add(cgame g, cgame solution, uint nb_solutions);
+
+/**
+ * @brief Creates the key of the puzzle of a game
+ * @param g the game
+ * @return the key, or NULL if no cache is opened (the functions taking a key
+ * then do nothing)
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+solution_cache_key solution_cache_key_new(cgame g);
+
+/**
+ * @brief Deletes a key
+ * @param key the key, or NULL
+ **/
+void solution_cache_key_delete(solution_cache_key key);
+
+/**
+ * @brief Gives the cached solution of a puzzle
+ * @param key the key of the puzzle of @p g, or NULL
+ * @param g the game
+ * @param squares receives the game_nb_rows(g) * game_nb_cols(g) squares of
+ * the solution, in row-major order, if there is one in the cache
+ * @return true if the cache has a solution of the puzzle
+ * @pre @p g must be a valid pointer toward a game structure.
+ **/
+bool solution_cache_key_solution(solution_cache_key key, cgame g,
+                                 unsigned char *squares);
+
+/**
+ * @brief Gives the cached number of solutions of a puzzle
+ * @param key the key of the puzzle, or NULL
+ * @return the number of solutions, or SOLUTION_CACHE_UNKNOWN
+ **/
+uint solution_cache_key_nb_solutions(solution_cache_key key);
+
+/**
+ * @brief Records what is known of a puzzle
+ * @details Nothing is written if the cache already knew it.
+ * @param key the key of the puzzle, or NULL
+ * @param solution a solution of the puzzle, or NULL if it isn't known
+ * @param nb_solutions the number of solutions, or SOLUTION_CACHE_UNKNOWN
+ **/
+void solution_cache_key_add(solution_cache_key key, cgame solution,
+                            uint nb_solutions);
+
+#endif  // __SOLUTION_CACHE_H__
@@ -0,0 +1,337 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "extra_functions.h"
+#include "game.h"
+#include "game_aux.h"
+#include "game_ext.h"
+#include "game_tools.h"
+#include "queue.h"
+#include "solution_cache.h"
+
+/*
+ * Solver daemon: it listens on a Unix domain socket, and a pool of worker
+ * threads answers the requests of the clients, so that no process has to be
+ * started and no file has to be read for each solve.
+ *
+ * A client sends any number of requests on its connection, each one being a
+ * line with the command, followed by the game in the format of game_save:
+ *   solve   answered by "solve ok" and the solved game, or by "solve none"
+ *   count   answered by "count N", N being the number of solutions
+ *   unique  answered by "unique yes" or "unique no"
+ * A request that can't be read is answered by "error ..." and the connection
+ * is closed. With -c, the answers are also kept in a solution cache file.
+ * With -t, a search that takes longer than the given number of seconds is
+ * stopped, and answered by "solve timeout", "count timeout" or "unique
+ * timeout".
+ */
+
+enum {
+  DEFAULT_NB_WORKERS = 4, /**< when the number of processors is unknown */
+  MAX_NB_WORKERS = 64,
+  MAX_GAME_SIZE = 1 << 20, /**< bigger games are refused */
+  LISTEN_BACKLOG = 64
+};
+
+/* connections waiting for a worker */
+typedef struct {
+  queue *clients; /* file descriptors, stored as pointers */
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+} client_queue;
+
+// Declaration of the functions that aren't given in the .h files
+static void usage(char *name);
+static void on_signal(int sig);
+static bool read_game(FILE *in, game *p_g);
+static void answer(FILE *out, const char *command, game g);
+static void serve(int fd, game *p_g);
+static void *work(void *data);
+
+static volatile sig_atomic_t stopping = 0;
+static double time_limit = 0; /* seconds per request, 0 for no limit */
+
+/* prints how to call the program, and exits */
+void usage(char *name) {
+  fprintf(stderr,
+          "Usage: %s [-w nb_workers] [-c cache_file] [-t seconds] "
+          "socket_path\n",
+          name);
+  exit(EXIT_FAILURE);
+}
+
+/* stops accepting connections */
+void on_signal(int sig) {
+  (void)sig;
+  stopping = 1;
+}
+
+/*
+ * Reads a game in the format of game_save. The game of the worker is reused
+ * when the new one has the same size and options, so that most requests
+ * don't allocate a game. Returns false if the game can't be read.
+ */
+bool read_game(FILE *in, game *p_g) {
+  uint nb_rows, nb_cols, wrapping, diagadj;
+  if (fscanf(in, "%u %u %u %u", &nb_rows, &nb_cols, &wrapping, &diagadj) !=
+          4 ||
+      nb_rows == 0 || nb_cols == 0 || nb_rows > MAX_GAME_SIZE / nb_cols) {
+    return false;
+  }
+  game g = *p_g;
+  if (g == NULL || game_nb_rows(g) != nb_rows || game_nb_cols(g) != nb_cols ||
+      game_is_wrapping(g) != (wrapping != 0) ||
+      game_is_diagadj(g) != (diagadj != 0)) {
+    game_delete(g);
+    g = game_new_empty_ext(nb_rows, nb_cols, wrapping != 0, diagadj != 0);
+    *p_g = g;
+  } else {
+    game_restart(g);  // clears the history of the previous request
+  }
+  for (uint i = 0; i < nb_rows; i++) {
+    uint nb_tents;
+    if (fscanf(in, "%u", &nb_tents) != 1) {
+      return false;
+    }
+    game_set_expected_nb_tents_row(g, i, nb_tents);
+  }
+  for (uint j = 0; j < nb_cols; j++) {
+    uint nb_tents;
+    if (fscanf(in, "%u", &nb_tents) != 1) {
+      return false;
+    }
+    game_set_expected_nb_tents_col(g, j, nb_tents);
+  }
+  // the squares start on the line after the column clues
+  int c;
+  while ((c = getc(in)) != '\n' && c != EOF) {
+  }
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      c = getc(in);
+      if (c == ' ') {
+        game_set_square(g, i, j, EMPTY);
+      } else if (c == 'x') {
+        game_set_square(g, i, j, TREE);
+      } else if (c == '*') {
+        game_set_square(g, i, j, TENT);
+      } else if (c == '-') {
+        game_set_square(g, i, j, GRASS);
+      } else {
+        return false;
+      }
+    }
+    c = getc(in);
+    if (c == '\r') {
+      c = getc(in);
+    }
+    if (c != '\n' && c != EOF) {
+      // the last row may be followed by the next request, as in a file
+      // that doesn't end with a newline
+      if (i + 1 < nb_rows) {
+        return false;
+      }
+      ungetc(c, in);
+    }
+  }
+  return true;
+}
+
+/* answers a command on a game that has been read */
+void answer(FILE *out, const char *command, game g) {
+  solve_options opts = {time_limit, 0, 0};
+  solve_status status;
+  uint nb_solutions = 0;
+  if (strcmp(command, "solve") == 0) {
+    status = game_solve_ext(g, &opts);
+  } else {
+    status = game_nb_solutions_ext(g, &opts, &nb_solutions);
+  }
+  if (status == SOLVE_TIMEOUT) {
+    fprintf(out, "%s timeout\n", command);
+  } else if (strcmp(command, "solve") == 0) {
+    if (status == SOLVE_FOUND) {
+      fprintf(out, "solve ok\n");
+      game_write(g, out);
+    } else {
+      fprintf(out, "solve none\n");
+    }
+  } else if (strcmp(command, "count") == 0) {
+    fprintf(out, "count %u\n", nb_solutions);
+  } else {
+    fprintf(out, "unique %s\n", nb_solutions == 1 ? "yes" : "no");
+  }
+}
+
+/* answers the requests of a client, until it closes the connection */
+void serve(int fd, game *p_g) {
+  FILE *in = fdopen(fd, "r");
+  int out_fd = dup(fd);
+  FILE *out = out_fd < 0 ? NULL : fdopen(out_fd, "w");
+  if (in == NULL || out == NULL) {
+    fprintf(stderr, "Couldn't open the connection: %s\n", strerror(errno));
+    if (in != NULL) {
+      fclose(in);
+    } else {
+      close(fd);
+    }
+    if (out != NULL) {
+      fclose(out);
+    } else if (out_fd >= 0) {
+      close(out_fd);
+    }
+    return;
+  }
+  char line[64];
+  while (fgets(line, sizeof(line), in) != NULL) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0') {
+      continue;
+    }
+    if (strcmp(line, "solve") != 0 && strcmp(line, "count") != 0 &&
+        strcmp(line, "unique") != 0) {
+      fprintf(out, "error unknown command\n");
+      break;
+    }
+    if (!read_game(in, p_g)) {
+      fprintf(out, "error bad game\n");
+      break;
+    }
+    answer(out, line, *p_g);
+    if (fflush(out) != 0) {
+      break;  // the client is gone
+    }
+  }
+  fclose(out);
+  fclose(in);
+}
+
+/* worker thread: serves the clients of the queue one after the other */
+void *work(void *data) {
+  client_queue *waiting = (client_queue *)data;
+  game g = NULL;  // reused from one request to the next
+  while (true) {
+    pthread_mutex_lock(&waiting->lock);
+    while (queue_is_empty(waiting->clients)) {
+      pthread_cond_wait(&waiting->not_empty, &waiting->lock);
+    }
+    int fd = (int)(intptr_t)queue_pop_tail(waiting->clients);
+    pthread_mutex_unlock(&waiting->lock);
+    serve(fd, &g);
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  long nb_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  if (nb_workers < 1) {
+    nb_workers = DEFAULT_NB_WORKERS;
+  }
+  char *cache_file = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "w:c:t:")) != -1) {
+    if (opt == 'w') {
+      nb_workers = strtol(optarg, NULL, 10);
+      if (nb_workers < 1) {
+        usage(argv[0]);
+      }
+    } else if (opt == 'c') {
+      cache_file = optarg;
+    } else if (opt == 't') {
+      time_limit = strtod(optarg, NULL);
+      if (time_limit <= 0) {
+        usage(argv[0]);
+      }
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1) {
+    usage(argv[0]);
+  }
+  if (nb_workers > MAX_NB_WORKERS) {
+    nb_workers = MAX_NB_WORKERS;
+  }
+  char *path = argv[optind];
+  if (cache_file != NULL && !solution_cache_open(cache_file)) {
+    fprintf(stderr, "Couldn't open the cache %s\n", cache_file);
+    exit(EXIT_FAILURE);
+  }
+
+  /* the socket */
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket path too long!\n");
+    exit(EXIT_FAILURE);
+  }
+  strcpy(addr.sun_path, path);
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0) {
+    fprintf(stderr, "socket: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  unlink(path);  // left by a previous run
+  if (bind(server, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(server, LISTEN_BACKLOG) != 0) {
+    fprintf(stderr, "Couldn't listen on %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  /* a signal interrupts accept, a client that leaves doesn't kill us */
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = on_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  /* the workers */
+  client_queue waiting;
+  waiting.clients = queue_new();
+  pthread_mutex_init(&waiting.lock, NULL);
+  pthread_cond_init(&waiting.not_empty, NULL);
+  for (long k = 0; k < nb_workers; k++) {
+    pthread_t worker;
+    if (pthread_create(&worker, NULL, work, &waiting) != 0) {
+      fprintf(stderr, "Couldn't start the workers!\n");
+      exit(EXIT_FAILURE);
+    }
+    pthread_detach(worker);
+  }
+  printf("Listening on %s with %ld workers\n", path, nb_workers);
+  fflush(stdout);
+
+  /* the connections are handed to the workers */
+  while (!stopping) {
+    int client = accept(server, NULL, NULL);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fprintf(stderr, "accept: %s\n", strerror(errno));
+      break;
+    }
+    pthread_mutex_lock(&waiting.lock);
+    queue_push_head(waiting.clients, (void *)(intptr_t)client);
+    pthread_cond_signal(&waiting.not_empty);
+    pthread_mutex_unlock(&waiting.lock);
+  }
+
+  // the requests being answered are dropped with the process
+  close(server);
+  unlink(path);
+  solution_cache_close();
+  return EXIT_SUCCESS;
+}